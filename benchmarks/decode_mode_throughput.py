@@ -0,0 +1,68 @@
+# This copyright notice applies to this file only
+#
+# SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+# SPDX-License-Identifier: MIT
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+"""
+Thumbnail extraction throughput of the decode modes.
+
+Decodes the input with every decode mode and reports the frames output per second and
+the speedup over full decode. KEYFRAME_ONLY also drops non-key packets in the demuxer,
+so they are neither read into packets nor parsed.
+
+    python benchmarks/decode_mode_throughput.py long_gop.mp4
+"""
+
+import argparse
+import time
+
+import PyNvVideoCodec as nvc
+
+
+def run(filename, gpuid, mode):
+    demuxer = nvc.CreateDemuxer(filename=filename)
+    decoder = nvc.CreateDecoder(gpuid=gpuid, codec=demuxer.GetNvCodecId(), usedevicememory=True, decodemode=mode)
+    if mode == nvc.Decode_Mode.KEYFRAME_ONLY:
+        demuxer.SetKeyFramesOnly(True)
+    count = 0
+    start = time.perf_counter()
+    # the last packet is empty and flushes the decoder
+    for packet in demuxer:
+        count += len(decoder.Decode(packet))
+    return count, time.perf_counter() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", help="input file, ideally with long GOPs")
+    parser.add_argument("--gpuid", type=int, default=0, help="GPU the decoder runs on")
+    args = parser.parse_args()
+
+    print(f"{'mode':>16} {'frames':>8} {'seconds':>9} {'frames/s':>10} {'speedup':>8}")
+    full_seconds = None
+    for mode in (nvc.Decode_Mode.FULL, nvc.Decode_Mode.REFERENCE_ONLY, nvc.Decode_Mode.KEYFRAME_ONLY):
+        count, elapsed = run(args.file, args.gpuid, mode)
+        full_seconds = full_seconds or elapsed
+        print(f"{mode.name:>16} {count:>8} {elapsed:>9.2f} {count / elapsed:>10.1f} {full_seconds / elapsed:>7.2f}x")
+
+
+if __name__ == "__main__":
+    main()
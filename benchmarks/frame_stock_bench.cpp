@@ -0,0 +1,176 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Per-frame overhead of taking a frame out of the decoder frame stock and returning it, as done by
+// NvDecoder::GetLockedFrame() and NvDecoder::UnlockFrame(). Compares the previous stock, two vectors erased from the
+// front, with the RingBuffer of frame descriptors the decoder uses now.
+//
+// Build:
+//   g++ -O2 -std=c++17 -pthread -I<CUDA>/include -Isrc/VideoCodecSDKUtils/helper_classes/Utils
+//       benchmarks/frame_stock_bench.cpp -o frame_stock_bench
+// Run:
+//   ./frame_stock_bench [cycles=100000]
+
+#include "NvCodecUtils.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Frame stock before the ring buffer: parallel vectors of frames and timestamps
+class VectorStock
+{
+public:
+    uint8_t* Lock(int64_t* pTimestamp)
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (m_vpFrame.empty())
+        {
+            return nullptr;
+        }
+        uint8_t* pFrame = m_vpFrame[0];
+        m_vpFrame.erase(m_vpFrame.begin(), m_vpFrame.begin() + 1);
+        *pTimestamp = m_vTimestamp[0];
+        m_vTimestamp.erase(m_vTimestamp.begin(), m_vTimestamp.begin() + 1);
+        return pFrame;
+    }
+
+    void Unlock(uint8_t* pFrame)
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_vpFrame.insert(m_vpFrame.end(), pFrame);
+        m_vTimestamp.insert(m_vTimestamp.end(), 0);
+    }
+
+private:
+    std::mutex m_mtx;
+    std::vector<uint8_t*> m_vpFrame;
+    std::vector<int64_t> m_vTimestamp;
+};
+
+// Frame stock of NvDecoder: a ring of frame descriptors
+class RingStock
+{
+public:
+    uint8_t* Lock(int64_t* pTimestamp)
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (m_vFrame.empty())
+        {
+            return nullptr;
+        }
+        FrameDesc frameDesc = m_vFrame.front();
+        m_vFrame.pop_front();
+        *pTimestamp = frameDesc.timestamp;
+        return frameDesc.pFrame;
+    }
+
+    void Unlock(uint8_t* pFrame)
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_vFrame.push_back({ pFrame, 0, 0 });
+    }
+
+private:
+    struct FrameDesc
+    {
+        uint8_t* pFrame;
+        int64_t timestamp;
+        int decodeStatus;
+    };
+    std::mutex m_mtx;
+    RingBuffer<FrameDesc> m_vFrame;
+};
+
+// Locks and unlocks nCycles frames out of a stock of nStock frames. With bOtherThread the frames are unlocked by a
+// second thread, as frames released by Python are. Returns the time per lock/unlock cycle in nanoseconds.
+template<typename Stock>
+double Run(int nCycles, int nStock, bool bOtherThread)
+{
+    Stock stock;
+    std::vector<uint8_t> vFrame(nStock);
+    for (int i = 0; i < nStock; i++)
+    {
+        stock.Unlock(&vFrame[i]);
+    }
+
+    ConcurrentQueue<uint8_t*> releaseQueue;
+    std::thread releaser;
+    if (bOtherThread)
+    {
+        releaser = std::thread([&] {
+            for (int i = 0; i < nCycles; i++)
+            {
+                stock.Unlock(releaseQueue.pop_front());
+            }
+        });
+    }
+
+    auto tStart = std::chrono::steady_clock::now();
+    int64_t timestamp = 0;
+    for (int i = 0; i < nCycles; i++)
+    {
+        uint8_t* pFrame = nullptr;
+        // the stock only runs empty while the releasing thread is behind
+        while (!(pFrame = stock.Lock(&timestamp)))
+        {
+            std::this_thread::yield();
+        }
+        if (bOtherThread)
+        {
+            releaseQueue.push_back(pFrame);
+        }
+        else
+        {
+            stock.Unlock(pFrame);
+        }
+    }
+    if (releaser.joinable())
+    {
+        releaser.join();
+    }
+    auto tEnd = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(tEnd - tStart).count() / nCycles;
+}
+
+int main(int argc, char** argv)
+{
+    int nCycles = argc > 1 ? atoi(argv[1]) : 100000;
+    printf("%d lock/unlock cycles, ns per cycle\n", nCycles);
+    printf("%-8s %-14s %12s %12s %8s\n", "stock", "unlock", "vector", "ring", "speedup");
+    for (bool bOtherThread : { false, true })
+    {
+        for (int nStock : { 4, 16, 64, 256 })
+        {
+            double vectorNs = Run<VectorStock>(nCycles, nStock, bOtherThread);
+            double ringNs = Run<RingStock>(nCycles, nStock, bOtherThread);
+            printf("%-8d %-14s %12.1f %12.1f %7.2fx\n", nStock, bOtherThread ? "other thread" : "same thread",
+                vectorNs, ringNs, vectorNs / ringNs);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+# This copyright notice applies to this file only
+#
+# SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+# SPDX-License-Identifier: MIT
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+"""
+Decode throughput versus latency over the decoder surface options.
+
+Decodes the input once for every combination of numoutputsurfaces, extradecodesurfaces
+and maxdisplaydelay, and reports the decoded frames per second together with the time to
+the first frame and the mean and 95th percentile of DecodedFrame.decode_latency_ms, the
+time from submitting a packet to its frame being output.
+
+    python benchmarks/surface_sweep.py input.mp4
+    python benchmarks/surface_sweep.py input.mp4 --zerocopy --outputsurfaces 2 4 8 --displaydelays 0 1 2 4
+"""
+
+import argparse
+import itertools
+import math
+import time
+
+import PyNvVideoCodec as nvc
+
+
+def percentile(values, fraction):
+    if not values:
+        return math.nan
+    values = sorted(values)
+    return values[min(len(values) - 1, int(fraction * len(values)))]
+
+
+def run(filename, gpuid, zerocopy, numoutputsurfaces, extradecodesurfaces, maxdisplaydelay):
+    demuxer = nvc.CreateDemuxer(filename=filename)
+    decoder = nvc.CreateDecoder(gpuid=gpuid, codec=demuxer.GetNvCodecId(), usedevicememory=True, zerocopy=zerocopy,
+                                numoutputsurfaces=numoutputsurfaces, extradecodesurfaces=extradecodesurfaces,
+                                maxdisplaydelay=maxdisplaydelay)
+    latencies = []
+    count = 0
+    first_frame = math.nan
+    start = time.perf_counter()
+    # the last packet is empty and flushes the decoder
+    for packet in demuxer:
+        for frame in decoder.Decode(packet):
+            count += 1
+            if math.isnan(first_frame):
+                first_frame = (time.perf_counter() - start) * 1000
+            if not math.isnan(frame.decode_latency_ms):
+                latencies.append(frame.decode_latency_ms)
+    elapsed = time.perf_counter() - start
+    return count / elapsed if elapsed else math.nan, first_frame, latencies
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", help="input file")
+    parser.add_argument("--outputsurfaces", type=int, nargs="+", default=[1, 2, 4, 8], help="numoutputsurfaces values")
+    parser.add_argument("--extrasurfaces", type=int, nargs="+", default=[0, 4], help="extradecodesurfaces values")
+    parser.add_argument("--displaydelays", type=int, nargs="+", default=[0, 1, 2, 4], help="maxdisplaydelay values")
+    parser.add_argument("--zerocopy", action="store_true", help="map output surfaces instead of copying frames")
+    parser.add_argument("--gpuid", type=int, default=0, help="GPU the decoder runs on")
+    args = parser.parse_args()
+
+    print(f"{'output':>6} {'extra':>6} {'delay':>6} {'fps':>10} {'first ms':>9} {'mean ms':>8} {'p95 ms':>8}")
+    for numoutputsurfaces, extradecodesurfaces, maxdisplaydelay in itertools.product(
+            args.outputsurfaces, args.extrasurfaces, args.displaydelays):
+        fps, first_frame, latencies = run(args.file, args.gpuid, args.zerocopy, numoutputsurfaces,
+                                          extradecodesurfaces, maxdisplaydelay)
+        mean = sum(latencies) / len(latencies) if latencies else math.nan
+        print(f"{numoutputsurfaces:>6} {extradecodesurfaces:>6} {maxdisplaydelay:>6} {fps:>10.1f} {first_frame:>9.2f}"
+              f" {mean:>8.2f} {percentile(latencies, 0.95):>8.2f}")
+
+
+if __name__ == "__main__":
+    main()
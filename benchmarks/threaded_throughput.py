@@ -0,0 +1,96 @@
+# This copyright notice applies to this file only
+#
+# SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+# SPDX-License-Identifier: MIT
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+"""
+Multi-threaded demux and decode throughput.
+
+Every thread opens its own demuxer and decoder on one of the input files, round robin,
+and processes the whole file. The aggregate rate is reported for each thread count,
+together with the scaling relative to one thread. Demux, Decode and Seek release the
+GIL, so the rate should grow with the thread count until the CPU or NVDEC is saturated.
+
+    python benchmarks/threaded_throughput.py input1.mp4 input2.mp4 --threads 1 2 4 8
+    python benchmarks/threaded_throughput.py input.mp4 --mode demux
+"""
+
+import argparse
+import threading
+import time
+
+import PyNvVideoCodec as nvc
+
+
+def run_worker(filename, mode, gpuid, counts, index, barrier):
+    demuxer = nvc.CreateDemuxer(filename=filename)
+    decoder = None
+    if mode == "decode":
+        decoder = nvc.CreateDecoder(gpuid=gpuid, codec=demuxer.GetNvCodecId(), usedevicememory=True)
+    barrier.wait()
+
+    count = 0
+    # the last packet is empty and flushes the decoder
+    for packet in demuxer:
+        if decoder is None:
+            count += 1 if packet.bsl else 0
+        else:
+            count += len(decoder.Decode(packet))
+    counts[index] = count
+
+
+def run(files, threads, mode, gpuid):
+    counts = [0] * threads
+    # demuxers and decoders are created before the clock starts
+    barrier = threading.Barrier(threads + 1)
+    workers = [threading.Thread(target=run_worker, args=(files[i % len(files)], mode, gpuid, counts, i, barrier))
+               for i in range(threads)]
+    for worker in workers:
+        worker.start()
+    barrier.wait()
+    start = time.perf_counter()
+    for worker in workers:
+        worker.join()
+    elapsed = time.perf_counter() - start
+    return sum(counts), elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("files", nargs="+", help="input files, assigned to the threads round robin")
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4, 8], help="thread counts to run")
+    parser.add_argument("--mode", choices=["decode", "demux"], default="decode",
+                        help="demux and decode every packet, or only demux")
+    parser.add_argument("--gpuid", type=int, default=0, help="GPU the decoders run on")
+    args = parser.parse_args()
+
+    unit = "frames" if args.mode == "decode" else "packets"
+    print(f"{'threads':>8} {unit:>10} {'seconds':>9} {unit + '/s':>12} {'scaling':>8}")
+    base_rate = None
+    for threads in args.threads:
+        count, elapsed = run(args.files, threads, args.mode, args.gpuid)
+        rate = count / elapsed
+        base_rate = base_rate or rate
+        print(f"{threads:>8} {count:>10} {elapsed:>9.2f} {rate:>12.1f} {rate / base_rate:>7.2f}x")
+
+
+if __name__ == "__main__":
+    main()
@@ -91,6 +91,10 @@ def CreateEncoder(
    ):
     cudacontext = 0
     cudastream = 0
+    gpuid = 0
+    if "gpuid" in kwargs:
+        gpuid = int(kwargs["gpuid"])
+        del kwargs["gpuid"]
     if "cudacontext" in kwargs:
         cudacontext = int(kwargs["cudacontext"])
         del kwargs["cudacontext"]
@@ -100,4 +104,4 @@ def CreateEncoder(
 
     optional_args = format_optional_params(kwargs)
 
-    return PyNvEncoder(width, height , fmt, cudacontext, cudastream,  usecpuinputbuffer ,optional_args)
\ No newline at end of file
+    return PyNvEncoder(width, height , fmt, cudacontext, cudastream,  usecpuinputbuffer ,optional_args, gpuid)
\ No newline at end of file
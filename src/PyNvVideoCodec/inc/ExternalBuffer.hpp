@@ -56,7 +56,11 @@ public:
 
     ExternalBuffer() = default;
     py::capsule dlpack(py::object stream) const;
-    int LoadDLPack(std::vector<size_t> _shape, std::vector<size_t> _stride, std::string _typeStr, size_t _streamid, CUdeviceptr _data, bool _readOnly);
+    int LoadDLPack(std::vector<size_t> _shape, std::vector<size_t> _stride, std::string _typeStr, size_t _streamid, CUdeviceptr _data, bool _readOnly,
+        DLDeviceType _deviceType = kDLCUDA, int _deviceId = 0);
+
+    // Keeps the memory backing the tensor alive for as long as this buffer or an exported capsule refers to it
+    void SetOwner(std::shared_ptr<void> owner) { m_owner = std::move(owner); }
 
 private:
 
@@ -64,6 +68,7 @@ private:
     friend py::detail::type_caster<ExternalBuffer>;
 
     DLPackTensor                    m_dlTensor;
+    std::shared_ptr<void>           m_owner;
 
     // __dlpack__ implementation
 
@@ -24,12 +24,16 @@
  */
 
 #include "FFmpegDemuxer.h"
+#include "PacketIndex.hpp"
 #include <chrono>
 #ifndef DEMUX_ONLY
 #include <cuda.h>
 #include <cuda_runtime.h>
 #endif
+#include <atomic>
+#include <exception>
 #include <mutex>
+#include <thread>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
@@ -61,11 +65,46 @@ class NvDemuxer {
 
 protected:
     std::unique_ptr<FFmpegDemuxer> demuxer;
-    std::shared_ptr <PacketData> currentPacket;
     bool isEOSReached;
+    std::string inputFile;
+    PacketIndex packetIndex;
+    uint64_t packetsToSeekTarget = 0;
+
+    // prefetch mode: a worker thread demuxes ahead into a bounded queue. A null packet marks the end of stream.
+    size_t prefetchDepth = 0;
+    std::thread prefetchThread;
+    std::unique_ptr<ConcurrentQueue<shared_ptr<PacketData>>> prefetchQueue;
+    std::atomic<bool> stopPrefetch{ false }, prefetchDone{ false };
+    std::atomic<uint64_t> prefetchBytes{ 0 };
+    std::atomic<int64_t> prefetchStallNs{ 0 };
+    std::exception_ptr prefetchError;
+
+    // drop the packets not flagged as key frames before they are returned, read by the prefetch thread
+    std::atomic<bool> keyFramesOnly{ false };
+    std::atomic<uint64_t> skippedPackets{ 0 };
+
+    bool ReadPacket(PacketData* pPacket);
+    shared_ptr<PacketData> DemuxPrefetched();
+    shared_ptr<PacketData> SeekDemuxer(uint64_t timestamp);
+    shared_ptr<PacketData> SeekWithIndex(uint64_t timestamp);
+    shared_ptr<PacketData> SeekToKeyPacket(size_t nKey);
+    void PrefetchLoop();
+    void StartPrefetch();
+    void StopPrefetch();
   
 public:
-    explicit NvDemuxer(const std::string&);
+    /**
+    *   @brief  Opens the input. A non zero prefetchDepth demuxes up to that many packets ahead on a worker thread.
+    */
+    explicit NvDemuxer(const std::string&, size_t prefetchDepth = 0);
+
+    /**
+    *   @brief  Reads the input through pDataProvider, which must outlive the demuxer
+    *   @param  avioBufferSize - size of the buffer AVIO reads from pDataProvider into
+    */
+    NvDemuxer(FFmpegDemuxer::DataProvider* pDataProvider, int avioBufferSize, size_t prefetchDepth = 0);
+
+    ~NvDemuxer();
     
     uint32_t GetWidth() {return demuxer->GetWidth();}
 
@@ -93,8 +132,69 @@ public:
 
     shared_ptr<PacketData> Demux();
 
+    /**
+    *   @brief  Seeks to the given time in milliseconds. With a packet index loaded, returns the key frame packet the
+    *   frame at that time has to be decoded from, otherwise the nearest key frame in the future.
+    */
     shared_ptr<PacketData> Seek(uint64_t timestamp);
 
+    /**
+    *   @brief  Scans the input once, writes the packet index to indexPath (or the default sidecar path) and uses it for seeking
+    */
+    void BuildIndex(const std::string& indexPath);
+
+    /**
+    *   @brief  Loads a packet index written by BuildIndex() and uses it for seeking
+    */
+    void LoadIndex(const std::string& indexPath);
+
+    /**
+    *   @brief  Number of packets, starting with the one returned by the last indexed Seek(), to decode to reach the target frame
+    */
+    uint64_t GetPacketsToSeekTarget() { return packetsToSeekTarget; }
+
+    /**
+    *   @brief  Seeks to entry nKey of the packet index, which must be a key frame, and returns its packet.
+    *   The following Demux() calls return the packets after it in decode order.
+    */
+    shared_ptr<PacketData> SeekToPacket(size_t nKey);
+
+    /**
+    *   @brief  Converts a time in seconds to the time base of the video stream
+    */
+    int64_t TsFromTime(double seconds) { return demuxer->TsFromTime(seconds); }
+
+    /**
+    *   @brief  Packet index loaded by BuildIndex() or LoadIndex(), empty otherwise
+    */
+    const PacketIndex& GetPacketIndex() const { return packetIndex; }
+
+    /**
+    *   @brief  Number of packets demuxed ahead and waiting in the prefetch queue
+    */
+    size_t GetPrefetchQueueDepth() { return prefetchQueue ? prefetchQueue->size() : 0; }
+
+    /**
+    *   @brief  Bitstream bytes held by the packets in the prefetch queue
+    */
+    uint64_t GetPrefetchBytes() { return prefetchBytes; }
+
+    /**
+    *   @brief  Total time in seconds Demux() waited on an empty prefetch queue
+    */
+    double GetPrefetchStallTime() { return prefetchStallNs / 1e9; }
+
+    /**
+    *   @brief  Returns key frame packets only, e.g. to decode thumbnails. Packets already demuxed ahead by the
+    *   prefetch thread are returned as they are.
+    */
+    void SetKeyFramesOnly(bool bKeyFramesOnly) { keyFramesOnly = bKeyFramesOnly; }
+
+    /**
+    *   @brief  Number of packets dropped because they were not key frames
+    */
+    uint64_t GetSkippedPackets() { return skippedPackets; }
+
     bool isEOF() { return isEOSReached; }
 
 
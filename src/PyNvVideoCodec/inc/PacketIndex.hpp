@@ -0,0 +1,121 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class FFmpegDemuxer;
+
+/**
+* @brief Index of the video packets of a stream, in decode order. Built by scanning the stream once and stored in a
+* sidecar file so that seeks can jump straight to the key frame preceding a target frame.
+*
+* The sidecar is a fixed layout little-endian file: a PacketIndex::Header followed by Header::count PacketIndex::Entry
+* records, so it can be read with a single call or memory-mapped as is.
+*/
+class PacketIndex {
+public:
+    struct Entry {
+        int64_t pos;    // byte offset of the packet in the file, -1 if unknown
+        int64_t pts;
+        int64_t dts;
+        uint32_t size;
+        uint32_t flags; // PacketIndex::FLAG_KEY
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t entrySize;
+        int32_t timeBaseNum;
+        int32_t timeBaseDen;
+        uint64_t count;
+        uint64_t sourceSize; // size of the indexed file, used to detect a stale sidecar
+    };
+
+    static const uint32_t FLAG_KEY = 1;
+
+    /**
+    *   @brief  Reads every video packet of the demuxer and records its metadata. Leaves the demuxer at end of stream.
+    */
+    void Build(FFmpegDemuxer& demuxer, uint64_t sourceSize);
+
+    /**
+    *   @brief  Writes the index to a sidecar file
+    */
+    void Save(const std::string& path) const;
+
+    /**
+    *   @brief  Reads a sidecar file written by Save(). Throws if the file is not a valid index.
+    */
+    void Load(const std::string& path);
+
+    /**
+    *   @brief  Finds the first frame in display order with pts >= targetPts, and the key frame it must be decoded from
+    *   @param  pTarget - index of the target packet
+    *   @param  pKey - index of the key frame packet decoding the target starts from, see GetKeyEntry()
+    *   @return false if the index is empty or the target is past the end of the stream
+    */
+    bool Find(int64_t targetPts, size_t* pTarget, size_t* pKey) const;
+
+    /**
+    *   @brief  Returns the entry of the n-th frame in display order
+    */
+    size_t GetDisplayEntry(size_t nFrame) const { return m_vDisplayOrder[nFrame]; }
+
+    /**
+    *   @brief  Returns the key frame entry decoding entry i starts from: the key frame at or before it in decode order,
+    *           or the one of the previous GOP if entry i is an open GOP leading picture displayed before its key frame
+    */
+    size_t GetKeyEntry(size_t i) const { return m_vKeyIndex[i]; }
+
+    /**
+    *   @brief  Returns the timestamp entry i is ordered by in display order: its pts, or its dts if it has no pts
+    */
+    int64_t GetDisplayTs(size_t i) const;
+
+    const Entry& operator[](size_t i) const { return m_vEntry[i]; }
+    size_t Size() const { return m_vEntry.size(); }
+    bool Empty() const { return m_vEntry.empty(); }
+    uint64_t GetSourceSize() const { return m_nSourceSize; }
+
+    /**
+    *   @brief  Returns the default sidecar path for a media file
+    */
+    static std::string GetDefaultPath(const std::string& mediaPath) { return mediaPath + ".nvidx"; }
+
+private:
+    void BuildLookup();
+
+    std::vector<Entry> m_vEntry;
+    // entry indices sorted by pts, for display order lookups
+    std::vector<uint32_t> m_vDisplayOrder;
+    // index of the key frame each entry is decoded from
+    std::vector<uint32_t> m_vKeyIndex;
+    int32_t m_nTimeBaseNum = 0, m_nTimeBaseDen = 0;
+    uint64_t m_nSourceSize = 0;
+};
@@ -29,6 +29,8 @@
 #include <cuda.h>
 #include <pybind11/pybind11.h>
 #include <string>
+#include <limits>
+#include <map>
 #include <vector>
 #include "nvEncodeAPI.h"
 #include "NvCodecUtils.h"
@@ -108,11 +110,21 @@ enum Pixel_Format {
     Pixel_Format_NV12 = 3,
     Pixel_Format_YUV444 = 4,
     Pixel_Format_P016 = 5,
-    Pixel_Format_YUV444_16Bit = 6
+    Pixel_Format_YUV444_16Bit = 6,
+    Pixel_Format_NV16 = 7,
+    Pixel_Format_P216 = 8
     
 };
 
 
+enum Decode_Status {
+    Decode_Status_UNKNOWN = 0,
+    Decode_Status_OK = 1,
+    Decode_Status_ERROR = 2,      /* decoded with an error that was not concealed */
+    Decode_Status_CONCEALED = 3   /* decoded with an error concealed by the decoder */
+};
+
+
 struct CAIMemoryView
 {
   std::vector<size_t>  shape;
@@ -121,6 +133,11 @@ struct CAIMemoryView
   CUstream             stream = nullptr;
   CUdeviceptr          data;
   bool                 readOnly;
+  std::shared_ptr<void> owner; // keeps the underlying memory alive while the view is referenced
+  // kDLCUDAHost for pinned and kDLCPU for pageable host frames, which have no __cuda_array_interface__
+  DLDeviceType         deviceType = kDLCUDA;
+  // ordinal of the GPU holding the data, 0 for host memory
+  int                  deviceId = 0;
     public:
   CAIMemoryView(std::vector<size_t> _shape, std::vector<size_t> _stride, std::string _typeStr, size_t _streamid, CUdeviceptr _data,  bool _readOnly)
  {
@@ -133,9 +150,25 @@ struct CAIMemoryView
   }
 };
 
+struct SEIMessage
+{
+    int                        type;
+    std::string                payload; // raw bytes, exposed to Python as bytes
+    // clock timestamps of a time code SEI, as parsed by the decoder
+    std::vector<std::map<std::string, int>> timecode;
+};
+
 struct DecodedFrame
 {
     int64_t                    timestamp;
+    double                     timestamp_seconds = std::numeric_limits<double>::quiet_NaN();
+    // time from submitting the packet to the frame being output by the decoder
+    double                     decode_latency_ms = std::numeric_limits<double>::quiet_NaN();
+    Decode_Status              decode_status = Decode_Status_UNKNOWN;
+    // frame data is in host memory, e.g. a pinned frame of a decoder created with usedevicememory=0
+    bool                       host_memory = false;
+    // SEI messages of the frame, empty unless SEI extraction is enabled
+    std::vector<SEIMessage>    sei_messages;
     std::vector<CAIMemoryView> views;
     Pixel_Format format;
     std::shared_ptr<ExternalBuffer> extBuf;
@@ -0,0 +1,87 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "PyNvDecoder.hpp"
+#include "PyNvDemuxer.hpp"
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+
+/**
+*   @brief  Runs a PyNvDecoder on a worker thread. Packets are either submitted by the caller or read from an attached
+*   demuxer, and decoded frames are handed out in display order. At most maxInFlight decoded frames wait for the caller;
+*   the worker stops decoding when that many are ready.
+*/
+class PyNvAsyncDecoder {
+private:
+    std::shared_ptr<PyNvDecoder> decoder;
+    // optional packet source, read by the worker instead of the packet queue
+    std::shared_ptr<PyNvDemuxer> demuxer;
+
+    // a null packet flushes the decoder, a null frame marks the end of the stream
+    ConcurrentQueue<std::shared_ptr<PacketData>> packetQueue;
+    ConcurrentQueue<std::shared_ptr<DecodedFrame>> frameQueue;
+
+    std::thread worker;
+    // streamEnded is set once the worker pushed its last end of stream marker
+    std::atomic<bool> stopWorker{ false }, workerDone{ false }, streamEnded{ false };
+    std::exception_ptr workerError;
+
+    void WorkerLoop();
+    void Stop();
+
+public:
+    PyNvAsyncDecoder(std::shared_ptr<PyNvDecoder> decoder, size_t maxInFlight, std::shared_ptr<PyNvDemuxer> demuxer = nullptr);
+    ~PyNvAsyncDecoder();
+
+    /**
+    *   @brief  Queues a packet for decoding. The packet must own its bitstream, as packets returned by the demuxer do
+    */
+    void Submit(const PacketData& packetData);
+
+    /**
+    *   @brief  Flushes the decoder once the packets queued so far are decoded
+    */
+    void EndOfStream();
+
+    /**
+    *   @brief  Waits for the next decoded frame, nullptr at the end of the stream.
+    *   The work on the decoder stream is ordered before cudaStream, or synchronized when cudaStream is 0.
+    */
+    std::shared_ptr<DecodedFrame> GetFrame(CUstream cudaStream);
+
+    /**
+    *   @brief  This function is used to get the number of decoded frames waiting for the caller
+    */
+    size_t GetNumReadyFrames() { return frameQueue.size(); }
+
+    /**
+    *   @brief  This function is used to get the number of submitted packets waiting for the worker
+    */
+    size_t GetNumPendingPackets() { return packetQueue.size(); }
+};
@@ -23,9 +23,14 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#pragma once
+
 #include "NvDecoder/NvDecoder.h"
 #include "NvCodecUtils.h"
 #include "PyCAIMemoryView.hpp"
+#include "PyNvMemoryPool.hpp"
+#include <cmath>
+#include <map>
 #include <mutex>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
@@ -38,11 +43,49 @@
 #include <iostream>
 #include <sstream>
 
-class PyNvDecoder {
+enum Timestamp_Unit {
+    Timestamp_Unit_NATIVE = 0, /* time base of the demuxed stream */
+    Timestamp_Unit_NANOSECONDS = 1,
+    Timestamp_Unit_MICROSECONDS = 2,
+    Timestamp_Unit_MILLISECONDS = 3
+};
+
+enum Decode_Mode {
+    Decode_Mode_FULL = 0,
+    Decode_Mode_REFERENCE_ONLY = 1, /* skip the pictures no other picture refers to */
+    Decode_Mode_KEYFRAME_ONLY = 2   /* decode intra pictures only */
+};
+
+class PyNvDecoder : public std::enable_shared_from_this<PyNvDecoder> {
 private:
-    bool m_bDestroyContext;
+    bool m_bReleasePrimaryContext;
+    CUdevice m_cuDevice = 0;
     CUcontext cuContext = NULL;
     CUstream cuStream = NULL;
+    // pool the decoded frames are allocated from, kept alive until the decoder is destroyed
+    std::shared_ptr<PyNvMemoryPool> m_memPool;
+    // keeps a CUDA context passed by the application alive until the decoder is destroyed
+    std::shared_ptr<void> m_contextOwner;
+
+    std::vector<DecodedFrame> DecodeZeroCopy(const PacketData pktdata);
+    DecodedFrame GetDecodedFrame(CUdeviceptr data, int64_t timestamp, std::shared_ptr<void> lease);
+
+    // time base of the packets passed to Decode, used to rescale frame timestamps
+    Timestamp_Unit m_eTimestampUnit = Timestamp_Unit_NATIVE;
+    // CUVID_PKT_ENDOFPICTURE in low latency mode, so that a picture is decoded as soon as its packet is parsed
+    int m_nDecodeFlags = 0;
+    // ordinal of the GPU the decoder runs on, reported with the frame views and DLPack tensors
+    int m_nDeviceOrdinal = 0;
+    int32_t m_nTimeBaseNum = 0, m_nTimeBaseDen = 0;
+    void SetTimeBase(const PacketData& packetData);
+    void SetFrameTimestamp(DecodedFrame& frame, int64_t timestamp);
+    DecodedFrame GetMappedDecodedFrame(CUdeviceptr data, unsigned int pitch, int64_t timestamp, std::shared_ptr<void> surface);
+    // adds the plane views and the DLPack tensor of a frame whose rows are pitch bytes apart
+    void SetFrameViews(DecodedFrame& frame, CUdeviceptr data, size_t pitch, size_t planeRows, std::shared_ptr<void> owner);
+
+    // SEI buffers swapped with the decoder for every frame, so that their capacity is reused
+    SEIMessages m_sei;
+    void SetFrameSEI(DecodedFrame& frame);
 
 protected:
     std::unique_ptr<NvDecoder> decoder;
@@ -55,13 +98,38 @@ public:
         size_t _context,
         size_t _stream,
         bool m_bUseDeviceFrame,
-        bool _enableasyncallocations
+        bool _enableasyncallocations,
+        bool _zerocopy = false,
+        bool _waitforfreesurface = false,
+        unsigned int _maxpoolframes = 0,
+        bool _blockonpool = false,
+        Timestamp_Unit _timestampunit = Timestamp_Unit_NATIVE,
+        Rect _croprect = {},
+        Dim _resizedim = {},
+        unsigned int _numoutputsurfaces = 2,
+        unsigned int _extradecodesurfaces = 0,
+        int _maxdisplaydelay = -1,
+        bool _lowlatency = false,
+        int _preallocframes = 0,
+        std::shared_ptr<PyNvMemoryPool> _mempool = nullptr,
+        bool _extractsei = false,
+        std::vector<int> _seitypes = {},
+        bool _droperrorframes = false,
+        bool _dropconcealedframes = false,
+        bool _pinnedhostmemory = false,
+        bool _pitchedframes = false,
+        Decode_Mode _decodemode = Decode_Mode_FULL
         );
 
     ~PyNvDecoder();
 
     Pixel_Format GetNativeFormat(const cudaVideoSurfaceFormat inputFormat);
     std::vector<DecodedFrame> Decode(const PacketData pktdata);
+
+    /**
+    *   @brief  Decodes a packet like Decode() but leaves the GIL alone, for callers running outside of Python threads
+    */
+    std::vector<DecodedFrame> DecodeFrames(const PacketData& pktdata);
     int GetNumDecodedFrame(const PacketData pktdata);
     uint8_t* GetLockedFrame(int64_t* pTimestamp);
     void UnlockFrame(uint8_t* pFrame);
@@ -139,6 +207,64 @@ public:
     */
     cudaVideoSurfaceFormat GetOutputFormat() { return decoder->GetOutputFormat(); }
 
+    /**
+    *   @brief  This function is used to get the number of decoder surfaces held by zero-copy frames
+    */
+    int GetNumMappedFrames() { return decoder->GetNumMappedFrames(); }
+
+    /**
+    *   @brief  This function is used to get the frame pool counters: hits, misses, frames in use, high-water mark
+    *   and frame allocations
+    */
+    std::map<std::string, int> GetFramePoolStats();
+
+    /**
+    *   @brief  This function is used to get the decode error, concealment, reconfiguration and dropped frame counters
+    */
+    std::map<std::string, int> GetDecodeStats();
+
+    /**
+    *   @brief  This function is used to get the output and decode surface counts and the maximum display delay
+    */
+    std::map<std::string, int> GetSurfaceConfig();
+
+    /**
+    *   @brief  This function is used to change the NVDEC crop rectangle and output size.
+    *   The change applies from the next sequence header. Zero crop or resize values disable them.
+    */
+    void SetCropResize(Rect cropRect, Dim resizeDim);
+
+    /**
+    *   @brief  This function selects the pictures that are decoded and output, from the next picture on
+    */
+    void SetDecodeMode(Decode_Mode decodeMode);
+
+    /**
+    *   @brief  This function prepares the decoder for a new bitstream, reusing the decoder session when it fits
+    */
+    void Reset(cudaVideoCodec codec);
+
+    /**
+    *   @brief  This function is used to get the number of decoder sessions reused and recreated by Reset()
+    */
+    std::map<std::string, int> GetSessionStats();
+
+    /**
+    *   @brief  This function gives access to the decoder, e.g. for the format of the current bitstream
+    */
+    NvDecoder* GetDecoder() { return decoder.get(); }
+
+    /**
+    *   @brief  This function is used to get the number of decoded frames still held by the application
+    */
+    int GetNumQueuedFrames() { return decoder->GetNumLockedFrames() + decoder->GetNumMappedFrames(); }
+
+    /**
+    *   @brief  This function makes the decoder hold a reference on the CUDA context it was created with,
+    *   e.g. the primary context retained by a session pool
+    */
+    void SetContextOwner(std::shared_ptr<void> owner) { m_contextOwner = std::move(owner); }
+
     void setDecoderSessionID(int sessionID) { decoder->setDecoderSessionID(sessionID); }
     
     static int64_t getDecoderSessionOverHead(int sessionID) { return NvDecoder::getDecoderSessionOverHead(sessionID); }
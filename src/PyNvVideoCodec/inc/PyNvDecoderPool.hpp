@@ -0,0 +1,82 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "PyNvDecoder.hpp"
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+/**
+*   @brief  Keeps decoders of finished bitstreams warm for the next bitstreams of the same kind.
+*   Idle decoders are keyed by codec, chroma format and bit depth. A decoder handed out by Acquire() returns to the
+*   pool when the application drops it, with its decoder session and frames, and is reset for its next bitstream.
+*   All decoders of the pool share the primary context of its GPU.
+*/
+class PyNvDecoderPool {
+public:
+    // creates a decoder for the codec on the given GPU and context, with the options of the pool
+    typedef std::function<std::shared_ptr<PyNvDecoder>(int gpuid, size_t context, cudaVideoCodec codec)> Factory;
+
+private:
+    typedef std::tuple<cudaVideoCodec, cudaVideoChromaFormat, int> Key;
+    struct State {
+        // primary context, released after the idle decoders are destroyed
+        std::shared_ptr<CUctx_st> context;
+        std::mutex mtx;
+        std::map<Key, std::vector<std::shared_ptr<PyNvDecoder>>> idle;
+        unsigned int nMaxIdle = 0;
+        int nHit = 0, nMiss = 0;
+    };
+    // shared with the decoders handed out, which only return to the pool while it exists
+    std::shared_ptr<State> m_state;
+
+    int m_nGpuId = 0;
+    Factory m_factory;
+
+    std::shared_ptr<PyNvDecoder> Wrap(std::shared_ptr<PyNvDecoder> decoder);
+
+public:
+    PyNvDecoderPool(int gpuid, unsigned int maxIdle, const Factory& factory);
+
+    /**
+    *   @brief  Returns an idle decoder of the given kind reset for a new bitstream, or a new decoder if there is none
+    */
+    std::shared_ptr<PyNvDecoder> Acquire(cudaVideoCodec codec, cudaVideoChromaFormat chromaFormat, int bitDepth);
+
+    /**
+    *   @brief  This function is used to get the number of idle decoders, and of acquisitions served warm and cold
+    */
+    std::map<std::string, int> GetStats();
+
+    /**
+    *   @brief  Destroys the idle decoders
+    */
+    void Clear();
+};
@@ -23,14 +23,25 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#pragma once
+
 #include "NvDemuxer.hpp"
 class PyNvDemuxer {
 
 protected:
+    // declared before the demuxer so that it is destroyed after it
+    std::unique_ptr<FFmpegDemuxer::DataProvider> dataProvider;
     std::unique_ptr<NvDemuxer> demuxer;
 
 public:
-    explicit PyNvDemuxer(const std::string&);
+    explicit PyNvDemuxer(const std::string&, size_t prefetchDepth = 0);
+
+    /**
+    *   @brief  Demuxes from a Python buffer-protocol object or a file-like object
+    */
+    PyNvDemuxer(std::unique_ptr<FFmpegDemuxer::DataProvider> provider, int avioBufferSize, size_t prefetchDepth = 0);
+
+    ~PyNvDemuxer();
 
     uint32_t Height() {return demuxer->GetHeight();}
 
@@ -54,6 +65,22 @@ public:
   
     shared_ptr<PacketData> Seek(uint64_t &timestamp);
 
+    void BuildIndex(const std::string& indexPath) { demuxer->BuildIndex(indexPath); }
+
+    void LoadIndex(const std::string& indexPath) { demuxer->LoadIndex(indexPath); }
+
+    uint64_t GetPacketsToSeekTarget() { return demuxer->GetPacketsToSeekTarget(); }
+
     bool isEndOfStream() { return demuxer->isEOF(); }
 
+    size_t GetPrefetchQueueDepth() { return demuxer->GetPrefetchQueueDepth(); }
+
+    uint64_t GetPrefetchBytes() { return demuxer->GetPrefetchBytes(); }
+
+    double GetPrefetchStallTime() { return demuxer->GetPrefetchStallTime(); }
+
+    void SetKeyFramesOnly(bool bKeyFramesOnly) { demuxer->SetKeyFramesOnly(bKeyFramesOnly); }
+
+    uint64_t GetSkippedPackets() { return demuxer->GetSkippedPackets(); }
+
 };
@@ -23,6 +23,9 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#pragma once
+
+#include <atomic>
 #include <map>
 #include <optional>
 
@@ -105,13 +108,16 @@ class PyNvEncoder {
 private:
     CUcontext m_CUcontext = nullptr;
     CUstream m_CUstream = nullptr;
-    bool m_bDestroyContext = false;
+    bool m_bReleasePrimaryContext = false;
+    CUdevice m_cuDevice = 0;
     std::map<CUdeviceptr, NV_ENC_REGISTERED_PTR> m_mapPtr;
     std::vector<py::object> m_vecFrameObj;
     size_t m_width;
     size_t m_height;
     uint64_t m_frameNum;
     std::unordered_map<uint64_t, uint64_t> m_mapFrameNumToTimestamp;
+    // frames submitted to the encoder whose bitstream has not been returned yet
+    std::atomic<int> m_nQueuedFrames{ 0 };
     NV_ENC_BUFFER_FORMAT m_eBufferFormat;
     bool m_bUseCPUInputBuffer;
 
@@ -125,7 +131,7 @@ protected:
 
 public:
     explicit PyNvEncoder(int width, int height,  std::string format,
-            size_t cudastream, size_t cudacontext, bool bUseCPUInputBuffer,std::map<std::string, std::string> config);
+            size_t cudastream, size_t cudacontext, bool bUseCPUInputBuffer,std::map<std::string, std::string> config, int gpuid = 0);
     PyNvEncoder(PyNvEncoder&& pyenvc);
     PyNvEncoder(PyNvEncoder& pyenvc);
     NV_ENC_REGISTERED_PTR RegisterInputFrame(const py::object obj, const CAIMemoryView frame); 
@@ -136,5 +142,10 @@ public:
     void InitEncodeReconfigureParams(const NV_ENC_INITIALIZE_PARAMS params);
     structEncodeReconfigureParams GetEncodeReconfigureParams();
 
+    /**
+    *   @brief  This function is used to get the number of frames submitted whose bitstream has not been returned yet
+    */
+    int GetNumQueuedFrames() { return m_nQueuedFrames; }
+
      ~PyNvEncoder();
 };
@@ -0,0 +1,78 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "NvCodecUtils.h"
+#include <cuda.h>
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+*   @brief  Stream-ordered memory pool that decoded frames are allocated from when asynchronous allocations are enabled.
+*   One pool can be shared by any number of decoders on its GPU, e.g. one pool per process and GPU.
+*/
+class PyNvMemoryPool {
+private:
+    CUmemoryPool m_hMemPool = NULL;
+    CUdevice m_cuDevice = 0;
+    int m_nGpuId = 0;
+    // the default pool of the device is configured but not destroyed
+    bool m_bDestroyPool = false;
+
+public:
+    /**
+    *   @brief  Creates a pool on the given GPU, or wraps the default pool of the GPU
+    *   @param  gpuid - GPU ordinal
+    *   @param  useDefaultPool - configure the default pool of the device instead of creating a pool
+    *   @param  releaseThreshold - bytes the pool keeps reserved across synchronizations, negative to keep all of them
+    *   @param  reuseFollowEventDependencies, reuseAllowOpportunistic, reuseAllowInternalDependencies - reuse policies of the pool
+    */
+    PyNvMemoryPool(int gpuid, bool useDefaultPool, int64_t releaseThreshold,
+        bool reuseFollowEventDependencies, bool reuseAllowOpportunistic, bool reuseAllowInternalDependencies);
+
+    ~PyNvMemoryPool();
+
+    CUmemoryPool GetHandle() { return m_hMemPool; }
+    CUdevice GetDevice() { return m_cuDevice; }
+    int GetGpuId() { return m_nGpuId; }
+
+    /**
+    *   @brief  This function sets the number of bytes the pool keeps reserved across synchronizations
+    *   @param  releaseThreshold - threshold in bytes, negative to keep all the memory
+    */
+    void SetReleaseThreshold(int64_t releaseThreshold);
+
+    /**
+    *   @brief  This function releases unused memory of the pool down to the given size
+    */
+    void Trim(size_t minBytesToKeep);
+
+    /**
+    *   @brief  This function is used to get the current and peak reserved and used memory of the pool
+    */
+    std::map<std::string, uint64_t> GetStats();
+};
@@ -0,0 +1,105 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "PyNvDecoder.hpp"
+#include "NvDemuxer.hpp"
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+*   @brief  Decodes the frames of a file at given frame indices or times. Every request seeks to the key frame its
+*   frame depends on, located with the packet index of the file, and decodes forward until the frame is output.
+*   A request ahead of the current position in the GOP being decoded continues decoding instead of seeking.
+*   Batched requests are served in decode order, so that each GOP is decoded at most once per batch.
+*/
+class PyNvRandomAccessDecoder {
+private:
+    struct Request {
+        size_t entry;   // packet index entry of the frame
+        size_t key;     // key frame entry it is decoded from
+        int64_t pts;
+        size_t slot;    // position of the frame in the result
+    };
+
+    std::unique_ptr<NvDemuxer> m_demuxer;
+    std::shared_ptr<PyNvDecoder> m_decoder;
+    cudaVideoCodec m_eCodec;
+
+    // decode position: key frame entry decoding started from, next entry to demux, and frames already output
+    // but not yet requested. m_nConsumedPts is the pts of the last frame discarded in display order.
+    bool m_bPositioned = false;
+    bool m_bFlushed = false;
+    size_t m_nSeekKey = 0, m_nNextPacket = 0;
+    int64_t m_nConsumedPts = INT64_MIN;
+    std::deque<DecodedFrame> m_vPending;
+    // key frame packet returned by the last seek, decoded first
+    std::shared_ptr<PacketData> m_pSeekPacket;
+
+    int m_nSeek = 0, m_nContinue = 0, m_nDecodedPacket = 0;
+    // serializes requests, which run without the GIL and share the demuxer, decoder and decode position
+    std::mutex m_mtxRequest;
+
+    Request MakeRequest(size_t entry, size_t slot);
+    void SeekToKey(size_t key);
+    bool DecodeNextPacket();
+    DecodedFrame GetFrame(const Request& request);
+    std::vector<DecodedFrame> GetFrames(std::vector<Request> requests);
+
+public:
+    /**
+    *   @brief  Opens a file and loads its packet index from indexPath, or the default sidecar path when indexPath is
+    *   empty. The index is built and written there first if it can't be loaded.
+    */
+    PyNvRandomAccessDecoder(const std::string& filename, int gpuid, bool useDeviceFrame, const std::string& indexPath);
+
+    /**
+    *   @brief  Returns the frames with the given indices in display order, in the order they were requested
+    */
+    std::vector<DecodedFrame> GetFramesByIndex(const std::vector<size_t>& indices);
+
+    /**
+    *   @brief  Returns the first frames displayed at or after the given times in seconds, in the order they were requested
+    */
+    std::vector<DecodedFrame> GetFramesAt(const std::vector<double>& times);
+
+    /**
+    *   @brief  Returns the number of frames of the file
+    */
+    size_t GetFrameCount() { return m_demuxer->GetPacketIndex().Size(); }
+
+    /**
+    *   @brief  This function is used to get the number of seeks, of requests served by decoding forward,
+    *   and of packets decoded
+    */
+    std::map<std::string, int> GetStats();
+
+    std::shared_ptr<PyNvDecoder> GetDecoder() { return m_decoder; }
+};
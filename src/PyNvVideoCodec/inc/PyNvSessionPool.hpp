@@ -0,0 +1,83 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "PyNvDecoder.hpp"
+#include "PyNvEncoder.hpp"
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+*   @brief  Spreads decoder and encoder sessions across GPUs.
+*   A session is placed on the GPU with the lowest live load, i.e. the number of active sessions
+*   plus the frames they still hold. All sessions of a GPU share its primary context.
+*/
+class PyNvSessionPool {
+private:
+    struct Device {
+        int gpuid = 0;
+        // primary context, released once the pool and all sessions created on this GPU are gone
+        std::shared_ptr<CUctx_st> context;
+        std::vector<std::weak_ptr<PyNvDecoder>> decoders;
+        std::vector<std::weak_ptr<PyNvEncoder>> encoders;
+    };
+
+    std::vector<Device> m_vDevice;
+    std::mutex m_mtxDevice;
+
+    /**
+    *   @brief  Drops expired sessions and returns the number of active sessions and queued frames of a GPU
+    */
+    static std::pair<int, int> GetLoad(Device& device);
+    Device& SelectDevice();
+
+public:
+    /**
+    *   @brief  Creates a pool over the given GPU ordinals, or over all GPUs when the list is empty
+    */
+    explicit PyNvSessionPool(const std::vector<int>& gpuids);
+
+    /**
+    *   @brief  Creates a decoder on the selected GPU by calling factory with its ordinal and primary context, so that
+    *   pooled decoders take the same options as CreateDecoder. The decoder keeps the context retained.
+    */
+    std::shared_ptr<PyNvDecoder> CreateDecoder(const std::function<std::shared_ptr<PyNvDecoder>(int gpuid, size_t context)>& factory);
+
+    std::shared_ptr<PyNvEncoder> CreateEncoder(
+        int width,
+        int height,
+        std::string format,
+        bool useCPUInputBuffer,
+        std::map<std::string, std::string> config);
+
+    /**
+    *   @brief  This function is used to get the active sessions and queued frames of every GPU in the pool
+    */
+    std::map<int, std::map<std::string, int>> GetDeviceLoad();
+};
@@ -95,8 +95,7 @@ py::tuple ExternalBuffer::strides() const
 
 std::string ExternalBuffer::dtype() const
 {
-    return std::string("|u1");
-    //return (m_dlTensor->dtype);
+    return m_dlTensor->dtype.bits == 16 ? std::string("|u2") : std::string("|u1");
 
 }
 
@@ -113,6 +112,11 @@ py::capsule ExternalBuffer::dlpack(py::object stream) const
         std::shared_ptr<const ExternalBuffer> extBuffer;
     };
 
+    if (m_dlTensor->data == nullptr)
+    {
+        throw std::runtime_error("DLPack tensor is not available for this buffer");
+    }
+
     auto ctx = std::make_unique<ManagerCtx>();
 
     // Set up tensor deleter to delete the ManagerCtx
@@ -175,14 +179,13 @@ void ExternalBuffer::Export(py::module &m)
         .def("__dlpack_device__", &ExternalBuffer::dlpackDevice, "Get the device associated with the buffer");
 }
 
-int ExternalBuffer::LoadDLPack( std::vector<size_t> _shape, std::vector<size_t> _stride, std::string _typeStr, size_t _streamid, CUdeviceptr _data, bool _readOnly)
+int ExternalBuffer::LoadDLPack( std::vector<size_t> _shape, std::vector<size_t> _stride, std::string _typeStr, size_t _streamid, CUdeviceptr _data, bool _readOnly,
+    DLDeviceType _deviceType, int _deviceId)
 {
     m_dlTensor->byte_offset = 0;
 
-    // TODO: infer the device type from the memory buffer
-    m_dlTensor->device.device_type = kDLCUDA;
-    // TODO: infer the device from the memory buffer
-    m_dlTensor->device.device_id = 0;
+    m_dlTensor->device.device_type = _deviceType;
+    m_dlTensor->device.device_id = _deviceId;
 
     // Convert data
 
@@ -191,15 +194,23 @@ int ExternalBuffer::LoadDLPack( std::vector<size_t> _shape, std::vector<size_t>
     m_dlTensor->data = ptr;
 
     // Convert DataType
-    if (_typeStr != "|u1" && _typeStr != "B")  // TODO: can also be other letters
+    int itemSizeDT = 0;
+    if (_typeStr == "|u1" || _typeStr == "B")  // TODO: can also be other letters
+    {
+        itemSizeDT = sizeof(uint8_t);
+    }
+    else if (_typeStr == "|u2" || _typeStr == "<u2")
+    {
+        itemSizeDT = sizeof(uint16_t);
+    }
+    else
     {
         throw std::runtime_error("Could not create DL Pack tensor! Invalid typstr: " + _typeStr);
         return -1;
     }
-    int itemSizeDT = sizeof(uint8_t);// dt.itemsize() 
 
     m_dlTensor->dtype.code = kDLUInt;
-    m_dlTensor->dtype.bits = 8;
+    m_dlTensor->dtype.bits = 8 * itemSizeDT;
     m_dlTensor->dtype.lanes = 1;
 
     // Convert ndim
@@ -33,46 +33,287 @@ namespace py = pybind11;
 simplelogger::Logger *logger = simplelogger::LoggerFactory::CreateConsoleLogger();
 #endif
 
-NvDemuxer::NvDemuxer(const std::string& inputfile)
+static uint64_t GetFileSize(const std::string& path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+    {
+        throw std::runtime_error("Unable to stat input file: " + path);
+    }
+    return (uint64_t)st.st_size;
+}
+
+NvDemuxer::NvDemuxer(const std::string& inputfile, size_t prefetchdepth)
 {
     demuxer.reset(new FFmpegDemuxer(inputfile.c_str()));
-    currentPacket.reset(new PacketData());
+    inputFile = inputfile;
+    isEOSReached = false;
+    prefetchDepth = prefetchdepth;
+    if (prefetchDepth)
+    {
+        StartPrefetch();
+    }
+}
+
+NvDemuxer::NvDemuxer(FFmpegDemuxer::DataProvider* pDataProvider, int avioBufferSize, size_t prefetchdepth)
+{
+    demuxer.reset(new FFmpegDemuxer(pDataProvider, avioBufferSize));
     isEOSReached = false;
+    prefetchDepth = prefetchdepth;
+    if (prefetchDepth)
+    {
+        StartPrefetch();
+    }
 }
 
-shared_ptr<PacketData> NvDemuxer::Demux()
+NvDemuxer::~NvDemuxer()
+{
+    StopPrefetch();
+}
+
+void NvDemuxer::StartPrefetch()
+{
+    prefetchQueue.reset(new ConcurrentQueue<shared_ptr<PacketData>>(prefetchDepth));
+    stopPrefetch = false;
+    prefetchDone = false;
+    prefetchBytes = 0;
+    prefetchError = nullptr;
+    prefetchThread = std::thread(&NvDemuxer::PrefetchLoop, this);
+}
+
+void NvDemuxer::StopPrefetch()
+{
+    if (!prefetchThread.joinable())
+    {
+        return;
+    }
+
+    stopPrefetch = true;
+    // The worker may be blocked on a full queue. Only the worker pushes, so a non empty queue never blocks pop_front.
+    while (!prefetchDone)
+    {
+        if (!prefetchQueue->empty())
+        {
+            prefetchQueue->pop_front();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    prefetchThread.join();
+    prefetchQueue->clear();
+    prefetchBytes = 0;
+}
+
+void NvDemuxer::PrefetchLoop()
+{
+    while (!stopPrefetch)
+    {
+        auto packet = std::make_shared<PacketData>();
+        bool bEOS = true;
+        try
+        {
+            bEOS = !ReadPacket(packet.get());
+        }
+        catch (...)
+        {
+            prefetchError = std::current_exception();
+        }
+
+        if (bEOS)
+        {
+            prefetchQueue->push_back(nullptr);
+            break;
+        }
+        prefetchBytes += packet->bsl;
+        prefetchQueue->push_back(packet);
+    }
+    prefetchDone = true;
+}
+
+bool NvDemuxer::ReadPacket(PacketData* pPacket)
+{
+    while (true)
+    {
+        int nVideoBytes = 0;
+        uint8_t* pVideo = NULL;
+        if (!demuxer->Demux(&pVideo, &nVideoBytes))
+        {
+            return false;
+        }
+        if (!nVideoBytes)
+        {
+            return true;
+        }
+        demuxer->GetPacketData(pPacket);
+        if (!keyFramesOnly || pPacket->key)
+        {
+            return true;
+        }
+        skippedPackets++;
+    }
+}
+
+shared_ptr<PacketData> NvDemuxer::DemuxPrefetched()
 {
-    int nVideoBytes = 0, nFrameReturned = 0, nFrame = 0;
-    uint8_t* pVideo = NULL, * pFrame;
-    memset(currentPacket.get(), 0, sizeof(PacketData));
+    auto start = steady_clock::now();
+    bool bStalled = prefetchQueue->empty();
+    auto packet = prefetchQueue->pop_front();
+    if (bStalled)
+    {
+        prefetchStallNs += duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    }
 
-    if (demuxer->Demux(&pVideo, &nVideoBytes))
+    if (!packet)
     {
-        if (nVideoBytes)
+        // Keep the end of stream marker so later calls do not block
+        prefetchQueue->push_back(nullptr);
+        isEOSReached = true;
+        if (prefetchError)
         {
-            currentPacket.get()->bsl_data = (uintptr_t)pVideo;
-            currentPacket.get()->bsl = nVideoBytes;
+            std::rethrow_exception(prefetchError);
         }
+        return std::make_shared<PacketData>();
+    }
+
+    prefetchBytes -= packet->bsl;
+    return packet;
+}
+
+void NvDemuxer::BuildIndex(const std::string& indexPath)
+{
+    if (inputFile.empty())
+    {
+        throw std::runtime_error("Packet index is only supported for file inputs");
+    }
+    // Scan with a separate demuxer so the read position of this one is not disturbed
+    FFmpegDemuxer scanner(inputFile.c_str());
+    PacketIndex index;
+    index.Build(scanner, GetFileSize(inputFile));
+    index.Save(indexPath.empty() ? PacketIndex::GetDefaultPath(inputFile) : indexPath);
+    packetIndex = std::move(index);
+}
+
+void NvDemuxer::LoadIndex(const std::string& indexPath)
+{
+    if (inputFile.empty())
+    {
+        throw std::runtime_error("Packet index is only supported for file inputs");
+    }
+    PacketIndex index;
+    index.Load(indexPath.empty() ? PacketIndex::GetDefaultPath(inputFile) : indexPath);
+    if (index.GetSourceSize() != GetFileSize(inputFile))
+    {
+        throw std::runtime_error("Packet index does not match input file " + inputFile + ". Rebuild it with BuildIndex");
+    }
+    packetIndex = std::move(index);
+}
+
+shared_ptr<PacketData> NvDemuxer::Demux()
+{
+    if (prefetchThread.joinable())
+    {
+        return DemuxPrefetched();
     }
-    else
+
+    // Every call returns a new packet holding its own reference on the demuxed data
+    auto packet = std::make_shared<PacketData>();
+    if (!ReadPacket(packet.get()))
     {
         isEOSReached = true;
     }
-    return currentPacket;
+    return packet;
+}
+
+shared_ptr<PacketData> NvDemuxer::SeekWithIndex(uint64_t timestamp)
+{
+    size_t nTarget = 0, nKey = 0;
+    packetsToSeekTarget = 0;
+    if (!packetIndex.Find(demuxer->TsFromTime(timestamp / 1000.0), &nTarget, &nKey))
+    {
+        return std::make_shared<PacketData>();
+    }
+
+    auto packet = SeekToKeyPacket(nKey);
+    if (!isEOSReached)
+    {
+        packetsToSeekTarget = nTarget - nKey + 1;
+    }
+    return packet;
+}
+
+shared_ptr<PacketData> NvDemuxer::SeekToPacket(size_t nKey)
+{
+    bool bPrefetch = prefetchThread.joinable();
+    StopPrefetch();
+    auto packet = SeekToKeyPacket(nKey);
+    if (bPrefetch)
+    {
+        StartPrefetch();
+    }
+    return packet;
+}
+
+shared_ptr<PacketData> NvDemuxer::SeekToKeyPacket(size_t nKey)
+{
+    if (nKey >= packetIndex.Size())
+    {
+        throw std::out_of_range("Packet index entry out of range");
+    }
+    const PacketIndex::Entry& key = packetIndex[nKey];
+    if (!demuxer->SeekToKeyFrame(key.dts))
+    {
+        throw std::runtime_error("Failed to seek");
+    }
+
+    auto packet = std::make_shared<PacketData>();
+    int nVideoBytes = 0;
+    uint8_t* pVideo = NULL;
+    while (demuxer->Demux(&pVideo, &nVideoBytes))
+    {
+        demuxer->GetPacketData(packet.get());
+        if (packet->dts == AV_NOPTS_VALUE || packet->dts >= key.dts)
+        {
+            isEOSReached = false;
+            return packet;
+        }
+    }
+
+    isEOSReached = true;
+    return std::make_shared<PacketData>();
+}
+
+shared_ptr<PacketData> NvDemuxer::Seek(uint64_t timestamp)
+{
+    // The worker owns the demuxer while prefetching. Restart it from the new position.
+    bool bPrefetch = prefetchThread.joinable();
+    StopPrefetch();
+    auto packet = SeekDemuxer(timestamp);
+    if (bPrefetch)
+    {
+        StartPrefetch();
+    }
+    return packet;
 }
 
-shared_ptr<PacketData> NvDemuxer:: Seek(uint64_t timestamp)
+shared_ptr<PacketData> NvDemuxer::SeekDemuxer(uint64_t timestamp)
 {
-    int nVideoBytes = 0, nFrameReturned = 0, nFrame = 0;
-    uint8_t* pVideo = NULL, * pFrame;
+    if (!packetIndex.Empty())
+    {
+        return SeekWithIndex(timestamp);
+    }
+
+    int nVideoBytes = 0;
+    uint8_t* pVideo = NULL;
+    auto packet = std::make_shared<PacketData>();
     SeekContext ctx;
     ctx.seek_frame = timestamp;
-    if (demuxer->Seek(ctx, &pVideo, &nVideoBytes))
+    if (demuxer->Seek(ctx, &pVideo, &nVideoBytes) && nVideoBytes)
     {
-        currentPacket.get()->bsl_data = (uintptr_t)pVideo;
-        currentPacket.get()->bsl = nVideoBytes;
+        demuxer->GetPacketData(packet.get());
     }
-    return currentPacket;
+    return packet;
 }
 
 ColorSpace NvDemuxer::GetColorSpace() const
@@ -0,0 +1,152 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "PacketIndex.hpp"
+#include "FFmpegDemuxer.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+static const char s_szIndexMagic[8] = { 'N', 'V', 'P', 'K', 'I', 'D', 'X', '\0' };
+static const uint32_t s_nIndexVersion = 1;
+
+static_assert(sizeof(PacketIndex::Entry) == 32, "PacketIndex::Entry must have a fixed layout");
+static_assert(sizeof(PacketIndex::Header) == 40, "PacketIndex::Header must have a fixed layout");
+
+void PacketIndex::Build(FFmpegDemuxer& demuxer, uint64_t sourceSize)
+{
+    m_vEntry.clear();
+    Entry entry = {};
+    int nSize = 0;
+    bool bKey = false;
+    while (demuxer.ReadPacketInfo(&entry.pos, &entry.pts, &entry.dts, &nSize, &bKey))
+    {
+        entry.size = (uint32_t)nSize;
+        entry.flags = bKey ? FLAG_KEY : 0;
+        m_vEntry.push_back(entry);
+    }
+
+    AVRational timeBase = demuxer.GetTimeBase();
+    m_nTimeBaseNum = timeBase.num;
+    m_nTimeBaseDen = timeBase.den;
+    m_nSourceSize = sourceSize;
+    BuildLookup();
+}
+
+void PacketIndex::Save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        throw std::runtime_error("Unable to open packet index file for writing: " + path);
+    }
+
+    Header header = {};
+    memcpy(header.magic, s_szIndexMagic, sizeof(header.magic));
+    header.version = s_nIndexVersion;
+    header.entrySize = sizeof(Entry);
+    header.timeBaseNum = m_nTimeBaseNum;
+    header.timeBaseDen = m_nTimeBaseDen;
+    header.count = m_vEntry.size();
+    header.sourceSize = m_nSourceSize;
+
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)m_vEntry.data(), m_vEntry.size() * sizeof(Entry));
+    if (!file)
+    {
+        throw std::runtime_error("Failed to write packet index file: " + path);
+    }
+}
+
+void PacketIndex::Load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Unable to open packet index file: " + path);
+    }
+
+    Header header = {};
+    file.read((char*)&header, sizeof(header));
+    if (!file || memcmp(header.magic, s_szIndexMagic, sizeof(header.magic)) || header.version != s_nIndexVersion
+        || header.entrySize != sizeof(Entry))
+    {
+        throw std::runtime_error("Invalid packet index file: " + path);
+    }
+
+    std::vector<Entry> vEntry(header.count);
+    file.read((char*)vEntry.data(), vEntry.size() * sizeof(Entry));
+    if (!file)
+    {
+        throw std::runtime_error("Truncated packet index file: " + path);
+    }
+
+    m_vEntry.swap(vEntry);
+    m_nTimeBaseNum = header.timeBaseNum;
+    m_nTimeBaseDen = header.timeBaseDen;
+    m_nSourceSize = header.sourceSize;
+    BuildLookup();
+}
+
+int64_t PacketIndex::GetDisplayTs(size_t i) const
+{
+    // Packets without a pts are ordered by their dts
+    return m_vEntry[i].pts != AV_NOPTS_VALUE ? m_vEntry[i].pts : m_vEntry[i].dts;
+}
+
+void PacketIndex::BuildLookup()
+{
+
+    m_vDisplayOrder.resize(m_vEntry.size());
+    m_vKeyIndex.resize(m_vEntry.size());
+    uint32_t nKey = 0, nPrevKey = 0;
+    for (uint32_t i = 0; i < m_vEntry.size(); i++)
+    {
+        m_vDisplayOrder[i] = i;
+        if (m_vEntry[i].flags & FLAG_KEY)
+        {
+            nPrevKey = nKey;
+            nKey = i;
+        }
+        // Open GOP leading picture: it is displayed before its key frame and references the previous GOP,
+        // which decoding has to start from
+        m_vKeyIndex[i] = (nKey > 0 && GetDisplayTs(i) < GetDisplayTs(nKey)) ? nPrevKey : nKey;
+    }
+    std::stable_sort(m_vDisplayOrder.begin(), m_vDisplayOrder.end(),
+        [this](uint32_t a, uint32_t b) { return GetDisplayTs(a) < GetDisplayTs(b); });
+}
+
+bool PacketIndex::Find(int64_t targetPts, size_t* pTarget, size_t* pKey) const
+{
+    auto it = std::lower_bound(m_vDisplayOrder.begin(), m_vDisplayOrder.end(), targetPts,
+        [this](uint32_t i, int64_t pts) { return GetDisplayTs(i) < pts; });
+    if (it == m_vDisplayOrder.end())
+    {
+        return false;
+    }
+
+    *pTarget = *it;
+    *pKey = m_vKeyIndex[*it];
+    return true;
+}
@@ -0,0 +1,265 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PyNvAsyncDecoder.hpp"
+
+using namespace std;
+
+namespace py = pybind11;
+
+PyNvAsyncDecoder::PyNvAsyncDecoder(std::shared_ptr<PyNvDecoder> _decoder, size_t maxInFlight, std::shared_ptr<PyNvDemuxer> _demuxer)
+    : decoder(std::move(_decoder)), demuxer(std::move(_demuxer))
+{
+    if (!decoder)
+    {
+        throw std::invalid_argument("A decoder is required");
+    }
+    if (maxInFlight == 0)
+    {
+        throw std::invalid_argument("At least one frame must be allowed in flight");
+    }
+    // packets are unbounded, frames are bounded by maxInFlight
+    packetQueue.setSize(0);
+    frameQueue.setSize(maxInFlight);
+    worker = std::thread(&PyNvAsyncDecoder::WorkerLoop, this);
+}
+
+PyNvAsyncDecoder::~PyNvAsyncDecoder()
+{
+    // The worker may need the GIL to read from a file-like demuxer source
+    py::gil_scoped_release release;
+    Stop();
+}
+
+void PyNvAsyncDecoder::Stop()
+{
+    if (!worker.joinable())
+    {
+        return;
+    }
+
+    stopWorker = true;
+    packetQueue.push_back(nullptr);
+    // The worker may be blocked on a full frame queue, or on frames in it holding the decoder's surfaces.
+    // Frames held by the application are not released by draining the queue, so the decoder stops waiting for them.
+    decoder->GetDecoder()->CancelFrameWait(true);
+    while (!workerDone)
+    {
+        if (!frameQueue.empty())
+        {
+            frameQueue.pop_front();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    worker.join();
+    // the decoder may be used on its own again
+    decoder->GetDecoder()->CancelFrameWait(false);
+    frameQueue.clear();
+    packetQueue.clear();
+}
+
+void PyNvAsyncDecoder::WorkerLoop()
+{
+    try
+    {
+        while (!stopWorker)
+        {
+            std::shared_ptr<PacketData> packet;
+            if (demuxer)
+            {
+                packet = demuxer->Demux();
+                if (!packet->bsl)
+                {
+                    if (!demuxer->isEndOfStream())
+                    {
+                        continue;
+                    }
+                    packet = nullptr;
+                }
+            }
+            else
+            {
+                packet = packetQueue.pop_front();
+            }
+            if (stopWorker)
+            {
+                break;
+            }
+
+            // An empty packet flushes the frames still held by the parser
+            auto frames = decoder->DecodeFrames(packet ? *packet : PacketData());
+            for (auto& frame : frames)
+            {
+                if (stopWorker)
+                {
+                    break;
+                }
+                frameQueue.push_back(std::make_shared<DecodedFrame>(std::move(frame)));
+            }
+
+            if (!packet)
+            {
+                if (demuxer)
+                {
+                    streamEnded = true;
+                    frameQueue.push_back(nullptr);
+                    break;
+                }
+                frameQueue.push_back(nullptr);
+            }
+        }
+    }
+    catch (...)
+    {
+        workerError = std::current_exception();
+        streamEnded = true;
+        frameQueue.push_back(nullptr);
+    }
+    workerDone = true;
+}
+
+void PyNvAsyncDecoder::Submit(const PacketData& packetData)
+{
+    if (demuxer)
+    {
+        throw std::runtime_error("Packets are read from the attached demuxer");
+    }
+    if (!packetData.bsl)
+    {
+        EndOfStream();
+        return;
+    }
+    packetQueue.push_back(std::make_shared<PacketData>(packetData));
+}
+
+void PyNvAsyncDecoder::EndOfStream()
+{
+    if (demuxer)
+    {
+        throw std::runtime_error("Packets are read from the attached demuxer");
+    }
+    packetQueue.push_back(nullptr);
+}
+
+std::shared_ptr<DecodedFrame> PyNvAsyncDecoder::GetFrame(CUstream cudaStream)
+{
+    auto frame = frameQueue.pop_front();
+    if (!frame)
+    {
+        if (streamEnded)
+        {
+            // Keep the end of stream marker so later calls do not block
+            frameQueue.push_back(nullptr);
+            if (workerError)
+            {
+                std::rethrow_exception(workerError);
+            }
+        }
+        return nullptr;
+    }
+
+    if (cudaStream)
+    {
+        decoder->CUStreamWaitOnEvent(cudaStream);
+    }
+    else
+    {
+        decoder->CUStreamSyncOnEvent();
+    }
+    return frame;
+}
+
+void Init_PyNvAsyncDecoder(py::module& m)
+{
+    py::class_<PyNvAsyncDecoder, shared_ptr<PyNvAsyncDecoder>>(m, "PyNvAsyncDecoder", py::module_local())
+        .def(py::init<std::shared_ptr<PyNvDecoder>, size_t, std::shared_ptr<PyNvDemuxer>>(),
+            py::arg("decoder"),
+            py::arg("maxinflight") = 4,
+            py::arg("demuxer") = nullptr,
+            R"pbdoc(
+                Constructor method. Decodes on a worker thread owned by this object
+                :param decoder: decoder created with CreateDecoder, not to be used directly while attached
+                :param maxinflight: maximum number of decoded frames waiting to be fetched
+                :param demuxer: optional demuxer the worker reads packets from, instead of packets passed to Submit
+            )pbdoc")
+        .def("Submit",
+            &PyNvAsyncDecoder::Submit,
+            py::arg("packet"),
+            py::call_guard<py::gil_scoped_release>(),
+            R"pbdoc(
+                Queues a packet returned by the demuxer for decoding. An empty packet ends the stream
+                :param packet: PacketData Structure
+            )pbdoc")
+        .def("EndOfStream",
+            &PyNvAsyncDecoder::EndOfStream,
+            py::call_guard<py::gil_scoped_release>(),
+            R"pbdoc(
+                Flushes the decoder once the queued packets are decoded. Decoding continues with later submitted packets
+            )pbdoc")
+        .def("GetFrame",
+            [](std::shared_ptr<PyNvAsyncDecoder>& self, size_t cudastream)
+            {
+                return self->GetFrame(reinterpret_cast<CUstream>(cudastream));
+            },
+            py::arg("cudastream") = 0,
+            py::call_guard<py::gil_scoped_release>(),
+            R"pbdoc(
+                Waits for the next decoded frame
+                :param cudastream: CUDA stream the decoding work is ordered before, 0 to synchronize with it
+                :return: DecodedFrame, or None at the end of the stream
+            )pbdoc")
+        .def("GetNumReadyFrames",
+            &PyNvAsyncDecoder::GetNumReadyFrames,
+            R"pbdoc(
+                Returns the number of decoded frames waiting to be fetched
+            )pbdoc")
+        .def("GetNumPendingPackets",
+            &PyNvAsyncDecoder::GetNumPendingPackets,
+            R"pbdoc(
+                Returns the number of submitted packets waiting to be decoded
+            )pbdoc")
+        .def("__iter__",
+            [](shared_ptr<PyNvAsyncDecoder> self)
+            {
+                return self;
+            })
+        .def("__next__",
+            [](shared_ptr<PyNvAsyncDecoder> self)
+            {
+                std::shared_ptr<DecodedFrame> frame;
+                {
+                    py::gil_scoped_release release;
+                    frame = self->GetFrame(nullptr);
+                }
+                if (!frame)
+                {
+                    throw py::stop_iteration();
+                }
+                return frame;
+            });
+}
@@ -32,15 +32,60 @@ using time_point_ms
 
 namespace py = pybind11;
 
+static void ValidateCropResize(const Rect& cropRect, const Dim& resizeDim)
+{
+    // NVDEC output dimensions must be even
+    if (cropRect.r || cropRect.b)
+    {
+        if (cropRect.l < 0 || cropRect.t < 0 || cropRect.r <= cropRect.l || cropRect.b <= cropRect.t)
+        {
+            throw std::invalid_argument("Invalid crop rectangle. Expected 0 <= left < right and 0 <= top < bottom");
+        }
+        if ((cropRect.r - cropRect.l) % 2 || (cropRect.b - cropRect.t) % 2)
+        {
+            throw std::invalid_argument("Crop width and height must be even");
+        }
+    }
+    if (resizeDim.w || resizeDim.h)
+    {
+        if (resizeDim.w <= 0 || resizeDim.h <= 0 || resizeDim.w % 2 || resizeDim.h % 2)
+        {
+            throw std::invalid_argument("Resize width and height must be positive and even");
+        }
+    }
+}
+
 PyNvDecoder::PyNvDecoder(
     int _gpuid,
     cudaVideoCodec _codec,
     size_t _context,
     size_t _stream,
     bool m_bUseDeviceFrame,
-    bool _enableasyncallocations
-) : m_bDestroyContext(false)
+    bool _enableasyncallocations,
+    bool _zerocopy,
+    bool _waitforfreesurface,
+    unsigned int _maxpoolframes,
+    bool _blockonpool,
+    Timestamp_Unit _timestampunit,
+    Rect _croprect,
+    Dim _resizedim,
+    unsigned int _numoutputsurfaces,
+    unsigned int _extradecodesurfaces,
+    int _maxdisplaydelay,
+    bool _lowlatency,
+    int _preallocframes,
+    std::shared_ptr<PyNvMemoryPool> _mempool,
+    bool _extractsei,
+    std::vector<int> _seitypes,
+    bool _droperrorframes,
+    bool _dropconcealedframes,
+    bool _pinnedhostmemory,
+    bool _pitchedframes,
+    Decode_Mode _decodemode
+) : m_bReleasePrimaryContext(false), m_memPool(_mempool), m_eTimestampUnit(_timestampunit), m_nDecodeFlags(_lowlatency ? CUVID_PKT_ENDOFPICTURE : 0)
 {
+    ValidateCropResize(_croprect, _resizedim);
+
     ck(cuInit(0));
     int nGpu = 0;
     ck(cuDeviceGetCount(&nGpu));
@@ -58,16 +103,25 @@ PyNvDecoder::PyNvDecoder(
     }
     else
     {
+        CUdevice cuDevice = 0;
+        ck(cuDeviceGet(&cuDevice, _gpuid));
         ck(cuCtxGetCurrent(&cuContext));
+        if (cuContext)
+        {
+            // the current context is only reused when it belongs to the requested GPU
+            CUdevice cuCurrentDevice = 0;
+            ck(cuCtxGetDevice(&cuCurrentDevice));
+            if (cuCurrentDevice != cuDevice)
+            {
+                cuContext = NULL;
+            }
+        }
         if(!cuContext)
         {
-            CUdevice cuDevice = 0;
-            ck(cuDeviceGet(&cuDevice, 0));
-            createCudaContext(&cuContext, _gpuid, 0);
-            ck(cuCtxPopCurrent(&cuContext));
-            m_bDestroyContext = true;
+            ck(cuDevicePrimaryCtxRetain(&cuContext, cuDevice));
+            m_cuDevice = cuDevice;
+            m_bReleasePrimaryContext = true;
         }
-        //ck(cuCtxPopCurrent(&cuContext));
     }
 
     if(!cuContext)
@@ -87,16 +141,47 @@ PyNvDecoder::PyNvDecoder(
 
     }
 
-    decoder.reset(new NvDecoder(cuStream, cuContext, m_bUseDeviceFrame, _codec,false,_enableasyncallocations, false));
+    CUdevice cuContextDevice = 0;
+    ck(cuCtxPushCurrent(cuContext));
+    ck(cuCtxGetDevice(&cuContextDevice));
+    ck(cuCtxPopCurrent(NULL));
+    m_nDeviceOrdinal = static_cast<int>(cuContextDevice);
+
+    if (m_memPool)
+    {
+        if (!_enableasyncallocations)
+        {
+            throw std::invalid_argument("mempool requires enableasyncallocations");
+        }
+        if (cuContextDevice != m_memPool->GetDevice())
+        {
+            throw std::invalid_argument("mempool is not on the GPU of the decoder");
+        }
+    }
+
+    // Low latency mode outputs each picture from the decode callback, which is only correct without frame reordering
+    decoder.reset(new NvDecoder(cuStream, cuContext, m_bUseDeviceFrame, _codec, _lowlatency, _enableasyncallocations, false,
+        _pitchedframes && m_bUseDeviceFrame, &_croprect, &_resizedim, _extractsei, 0, 0, 1000, _lowlatency, _zerocopy, _waitforfreesurface,
+        _numoutputsurfaces, _extradecodesurfaces, _lowlatency ? 0 : _maxdisplaydelay));
+    decoder->SetFramePoolLimit(_maxpoolframes, _blockonpool);
+    decoder->SetFramePreallocation(_preallocframes);
+    decoder->SetSEIMessageFilter(_seitypes);
+    decoder->SetErrorFramePolicy(_droperrorframes, _dropconcealedframes);
+    decoder->SetPinnedHostFrames(_pinnedhostmemory);
+    SetDecodeMode(_decodemode);
+    if (m_memPool)
+    {
+        decoder->SetMemoryPool(m_memPool->GetHandle());
+    }
 
 }
 
 PyNvDecoder::~PyNvDecoder()
 {
     decoder.reset();
-    if (m_bDestroyContext)
+    if (m_bReleasePrimaryContext)
     {
-        ck(cuCtxDestroy(cuContext));
+        ck(cuDevicePrimaryCtxRelease(m_cuDevice));
     }
 }
 
@@ -108,6 +193,8 @@ Pixel_Format PyNvDecoder::GetNativeFormat(const cudaVideoSurfaceFormat inputForm
     case cudaVideoSurfaceFormat_P016: return Pixel_Format_P016;
     case cudaVideoSurfaceFormat_YUV444: return Pixel_Format_YUV444;
     case cudaVideoSurfaceFormat_YUV444_16Bit: return Pixel_Format_YUV444_16Bit;
+    case cudaVideoSurfaceFormat_NV16: return Pixel_Format_NV16;
+    case cudaVideoSurfaceFormat_P216: return Pixel_Format_P216;
     default:
         break;
     }
@@ -128,68 +215,358 @@ void PyNvDecoder::UnlockFrame(uint8_t* framePtr)
     decoder->UnlockFrame(framePtr);
 }
 
+std::map<std::string, int> PyNvDecoder::GetFramePoolStats()
+{
+    std::map<std::string, int> stats;
+    stats["hits"] = decoder->GetFramePoolHits();
+    stats["misses"] = decoder->GetFramePoolMisses();
+    stats["in_use"] = decoder->GetNumLockedFrames();
+    stats["high_water"] = decoder->GetLockedFramesHighWater();
+    stats["allocated"] = decoder->GetNumAllocatedFrames();
+    stats["allocations"] = decoder->GetFrameAllocCount();
+    stats["frees"] = decoder->GetFrameFreeCount();
+    stats["preallocated"] = decoder->GetPreallocatedFrameCount();
+    return stats;
+}
+
+std::map<std::string, int> PyNvDecoder::GetSurfaceConfig()
+{
+    std::map<std::string, int> config;
+    config["output_surfaces"] = decoder->GetNumOutputSurfaces();
+    config["decode_surfaces"] = decoder->GetNumDecodeSurfaces();
+    config["max_display_delay"] = decoder->GetMaxDisplayDelay();
+    return config;
+}
+
+void PyNvDecoder::SetCropResize(Rect cropRect, Dim resizeDim)
+{
+    ValidateCropResize(cropRect, resizeDim);
+    decoder->setReconfigParams(&cropRect, &resizeDim);
+}
+
+void PyNvDecoder::SetDecodeMode(Decode_Mode decodeMode)
+{
+    switch (decodeMode)
+    {
+    case Decode_Mode_FULL: decoder->SetPictureSkipMode(false, false); break;
+    case Decode_Mode_REFERENCE_ONLY: decoder->SetPictureSkipMode(true, false); break;
+    case Decode_Mode_KEYFRAME_ONLY: decoder->SetPictureSkipMode(false, true); break;
+    default:
+        throw std::invalid_argument("unknown decode mode");
+    }
+}
+
+void PyNvDecoder::Reset(cudaVideoCodec codec)
+{
+    // the time base is taken from the packets of the new bitstream
+    m_nTimeBaseNum = 0;
+    m_nTimeBaseDen = 0;
+    py::gil_scoped_release release;
+    decoder->Reset(codec);
+}
+
+std::map<std::string, int> PyNvDecoder::GetSessionStats()
+{
+    std::map<std::string, int> stats;
+    stats["reuses"] = decoder->GetNumSessionReuses();
+    stats["recreations"] = decoder->GetNumSessionRecreations();
+    return stats;
+}
+
+static Decode_Status ToDecodeStatus(cuvidDecodeStatus decodeStatus)
+{
+    switch (decodeStatus)
+    {
+    case cuvidDecodeStatus_Success:
+        return Decode_Status_OK;
+    case cuvidDecodeStatus_Error:
+        return Decode_Status_ERROR;
+    case cuvidDecodeStatus_Error_Concealed:
+        return Decode_Status_CONCEALED;
+    default:
+        return Decode_Status_UNKNOWN;
+    }
+}
+
+std::map<std::string, int> PyNvDecoder::GetDecodeStats()
+{
+    std::map<std::string, int> stats;
+    stats["errors"] = decoder->GetDecodeErrorCount();
+    stats["concealed"] = decoder->GetDecodeConcealedCount();
+    stats["dropped_frames"] = decoder->GetDroppedFrameCount();
+    stats["reconfigurations"] = decoder->GetReconfigureCount();
+    stats["skipped_pictures"] = decoder->GetSkippedPictureCount();
+    return stats;
+}
+
+void PyNvDecoder::SetFrameSEI(DecodedFrame& frame)
+{
+    cudaVideoCodec codec = decoder->GetCodec();
+    const uint8_t* pPayload = m_sei.data.data();
+    for (const CUSEIMESSAGE& message : m_sei.messages)
+    {
+        SEIMessage sei;
+        sei.type = message.sei_message_type;
+        sei.payload.assign(reinterpret_cast<const char*>(pPayload), message.sei_message_size);
+        if ((codec == cudaVideoCodec_H264 || codec == cudaVideoCodec_HEVC) && message.sei_message_type == SEI_TYPE_TIME_CODE
+            && message.sei_message_size >= sizeof(HEVCSEITIMECODE))
+        {
+            HEVCSEITIMECODE timecode;
+            memcpy(&timecode, pPayload, sizeof(timecode));
+            for (int i = 0; i < (std::min)((int)timecode.num_clock_ts, MAX_CLOCK_TS); i++)
+            {
+                const HEVCTIMECODESET& set = timecode.time_code_set[i];
+                sei.timecode.push_back({
+                    { "hours", set.hours_value },
+                    { "minutes", set.minutes_value },
+                    { "seconds", set.seconds_value },
+                    { "frames", set.n_frames },
+                    { "time_offset", (int)set.time_offset_value },
+                    { "counting_type", set.counting_type },
+                    { "discontinuity", set.discontinuity_flag },
+                    { "dropped_frames", set.cnt_dropped_flag } });
+            }
+        }
+        frame.sei_messages.push_back(std::move(sei));
+        pPayload += message.sei_message_size;
+    }
+}
+
+void PyNvDecoder::SetTimeBase(const PacketData& packetData)
+{
+    if (packetData.time_base_den > 0)
+    {
+        m_nTimeBaseNum = packetData.time_base_num;
+        m_nTimeBaseDen = packetData.time_base_den;
+    }
+}
+
+void PyNvDecoder::SetFrameTimestamp(DecodedFrame& frame, int64_t timestamp)
+{
+    frame.timestamp = timestamp;
+    // INT64_MIN is AV_NOPTS_VALUE, the demuxer did not provide a pts for this frame
+    if (!m_nTimeBaseDen || timestamp == INT64_MIN)
+    {
+        return;
+    }
+
+    long double seconds = (long double)timestamp * m_nTimeBaseNum / m_nTimeBaseDen;
+    frame.timestamp_seconds = (double)seconds;
+    switch (m_eTimestampUnit)
+    {
+    case Timestamp_Unit_NANOSECONDS: frame.timestamp = llroundl(seconds * 1000000000); break;
+    case Timestamp_Unit_MICROSECONDS: frame.timestamp = llroundl(seconds * 1000000); break;
+    case Timestamp_Unit_MILLISECONDS: frame.timestamp = llroundl(seconds * 1000); break;
+    default: break;
+    }
+}
+
 int PyNvDecoder::GetNumDecodedFrame(const PacketData packetData)
 {
     NVTX_SCOPED_RANGE("py::GetNumDecodedFrame")
-    int  numFrames = decoder->Decode((uint8_t*)packetData.bsl_data, packetData.bsl, 0);
+    SetTimeBase(packetData);
+    py::gil_scoped_release release;
+    int  numFrames = decoder->Decode((uint8_t*)packetData.bsl_data, packetData.bsl, m_nDecodeFlags, packetData.pts);
     return numFrames;
 }
 
 
-std::vector<DecodedFrame> PyNvDecoder::Decode(const PacketData packetData)
+void PyNvDecoder::SetFrameViews(DecodedFrame& frame, CUdeviceptr data, size_t pitch, size_t planeRows, std::shared_ptr<void> owner)
 {
-    NVTX_SCOPED_RANGE("py::decode")
-    std::vector<DecodedFrame> frames;
-    auto vecTupFrame = decoder->Decode((uint8_t*)packetData.bsl_data, packetData.bsl);
-    std::transform(vecTupFrame.begin(), vecTupFrame.end(), std::back_inserter(frames),
-        [=](std::tuple<CUdeviceptr, int64_t> tup)
+    auto width = size_t(decoder->GetWidth());
+    auto height = size_t(decoder->GetHeight());
+    auto chromaHeight = size_t(decoder->GetChromaHeight());
+    auto planeSize = pitch * planeRows;
+    auto stream = reinterpret_cast<size_t>(decoder->GetStream());
+    DLDeviceType deviceType = kDLCUDA;
+    // DLPack numbers host memory as device 0
+    int deviceId = m_nDeviceOrdinal;
+    if (frame.host_memory)
+    {
+        deviceType = decoder->IsPinnedHostFrames() ? kDLCUDAHost : kDLCPU;
+        deviceId = 0;
+    }
+
+    // Strides are in bytes and rows are pitch bytes apart; every plane starts planeRows rows after the previous one
+    switch (frame.format)
+    {
+        case Pixel_Format_NV12:
+        case Pixel_Format_P016:
+        case Pixel_Format_NV16:
+        case Pixel_Format_P216:
         {
-            DecodedFrame frame;
-
-            frame.format = GetNativeFormat(decoder->GetOutputFormat());
-            auto width = size_t(decoder->GetWidth());
-            auto height = size_t(decoder->GetHeight());
-            auto data = std::get<0>(tup);
-            auto timestamp = std::get<1>(tup);
-            frame.timestamp = timestamp;
-            switch (frame.format)
+            // 4:2:2 has one chroma row per luma row, chromaHeight covers both subsamplings
+            bool b16Bit = frame.format == Pixel_Format_P016 || frame.format == Pixel_Format_P216;
+            size_t bpp = b16Bit ? 2 : 1;
+            std::string typestr = b16Bit ? "|u2" : "|u1";
+            frame.views.push_back(CAIMemoryView{ {height, width, 1}, {pitch, bpp, bpp}, typestr, stream, data, false });
+            frame.views.push_back(CAIMemoryView{ {chromaHeight, width / 2, 2}, {pitch, 2 * bpp, bpp}, typestr, stream, data + planeSize, false });
+            // A single tensor can describe both planes only when chroma directly follows luma
+            if (planeRows == height)
             {
-                case Pixel_Format_NV12:
-                {
-                    frame.views.push_back(CAIMemoryView{ {height, width, 1}, {width, 1, 1}, "|u1",reinterpret_cast<size_t>( decoder->GetStream()) ,(data), false });
-                    frame.views.push_back(CAIMemoryView{ {height / 2, width / 2, 2}, {width / 2 * 2, 2, 1}, "|u1",reinterpret_cast<size_t>(decoder->GetStream()),(data + width * height), false });//todo: data+width*height assumes both planes are contiguous. Actual NVENC allocation can have padding?
-                    // Load DLPack Tensor
-                    std::vector<size_t> shape{ (size_t)(height * 1.5), width};
-                    std::vector<size_t> stride{ size_t(width), 1};
-                    int returntype = frame.extBuf->LoadDLPack( shape, stride, "|u1", reinterpret_cast<size_t>(decoder->GetStream()), data, false );
-                }
-                break;
-                case Pixel_Format_P016:
-                {
-                    frame.views.push_back(CAIMemoryView{ {height, width, 1}, {width, 1, 1}, "|u2",reinterpret_cast<size_t>(decoder->GetStream()) ,(data), false });
-                    frame.views.push_back(CAIMemoryView{ {height / 2, width / 2, 2}, {width / 2 * 2, 2, 1}, "|u2",reinterpret_cast<size_t>(decoder->GetStream()),(data + 2*(width * height)), false });//todo: data+width*height assumes both planes are contiguous. Actual NVENC allocation can have padding?
-                }
-                break;
-                case Pixel_Format_YUV444:
+                std::vector<size_t> shape{ height + chromaHeight, width };
+                std::vector<size_t> stride{ pitch, bpp };
+                frame.extBuf->LoadDLPack(shape, stride, typestr, stream, data, false, deviceType, deviceId);
+            }
+        }
+        break;
+        case Pixel_Format_YUV444:
+        case Pixel_Format_YUV444_16Bit:
+        {
+            size_t bpp = frame.format == Pixel_Format_YUV444_16Bit ? 2 : 1;
+            std::string typestr = frame.format == Pixel_Format_YUV444_16Bit ? "|u2" : "|u1";
+            for (size_t plane = 0; plane < 3; plane++)
+            {
+                frame.views.push_back(CAIMemoryView{ {height, width, 1}, {pitch, bpp, bpp}, typestr, stream, data + plane * planeSize, false });
+            }
+            std::vector<size_t> shape{ 3, height, width };
+            std::vector<size_t> stride{ planeSize, pitch, bpp };
+            frame.extBuf->LoadDLPack(shape, stride, typestr, stream, data, false, deviceType, deviceId);
+        }
+        break;
+        default:
+            break;
+    }
+
+    for (auto& view : frame.views)
+    {
+        view.owner = owner;
+        view.deviceType = deviceType;
+        view.deviceId = deviceId;
+    }
+    frame.extBuf->SetOwner(owner);
+}
+
+DecodedFrame PyNvDecoder::GetMappedDecodedFrame(CUdeviceptr data, unsigned int pitch, int64_t timestamp, std::shared_ptr<void> surface)
+{
+    DecodedFrame frame;
+    frame.format = GetNativeFormat(decoder->GetOutputFormat());
+    SetFrameTimestamp(frame, timestamp);
+    // Mapped surfaces are pitched and planes are separated by the aligned surface height
+    SetFrameViews(frame, data, pitch, size_t(decoder->GetMappedPlaneHeight()), surface);
+    return frame;
+}
+
+DecodedFrame PyNvDecoder::GetDecodedFrame(CUdeviceptr data, int64_t timestamp, std::shared_ptr<void> lease)
+{
+    DecodedFrame frame;
+    frame.format = GetNativeFormat(decoder->GetOutputFormat());
+    frame.host_memory = !decoder->IsDeviceFrameOutput();
+    SetFrameTimestamp(frame, timestamp);
+    // Copied frames have the pitch of the frame allocation and planes follow each other without padding rows
+    SetFrameViews(frame, data, size_t(decoder->GetDeviceFramePitch()), size_t(decoder->GetHeight()), lease);
+    return frame;
+}
+
+std::vector<DecodedFrame> PyNvDecoder::DecodeZeroCopy(const PacketData packetData)
+{
+    NVTX_SCOPED_RANGE("py::decodezerocopy")
+    std::vector<DecodedFrame> frames;
+    int numFrames = 0;
+    SetTimeBase(packetData);
+    numFrames = decoder->Decode((uint8_t*)packetData.bsl_data, packetData.bsl, m_nDecodeFlags, packetData.pts);
+
+    auto self = shared_from_this();
+    for (int i = 0; i < numFrames; i++)
+    {
+        unsigned int pitch = 0;
+        int64_t timestamp = 0, latencyNs = 0;
+        cuvidDecodeStatus decodeStatus = cuvidDecodeStatus_Invalid;
+        CUdeviceptr data = decoder->GetMappedFrame(&pitch, &timestamp, &latencyNs, &m_sei, &decodeStatus);
+
+        // The surface is unmapped once the last frame, view or DLPack capsule referring to it is gone.
+        // Holding the PyNvDecoder keeps the decoder session alive until then.
+        std::shared_ptr<void> surface(reinterpret_cast<void*>(data), [self](void* ptr)
+            {
+                try
                 {
-                    frame.views.push_back(CAIMemoryView{ {height, width, 1}, {width, 1, 1}, "|u1",reinterpret_cast<size_t>(decoder->GetStream()) ,(data), false });
-                    frame.views.push_back(CAIMemoryView{ {height, width, 1}, {width, 1, 1}, "|u1",reinterpret_cast<size_t>(decoder->GetStream()),(data + width * height), false });//todo: data+width*height assumes both planes are contiguous. Actual NVENC allocation can have padding?
-                    frame.views.push_back(CAIMemoryView{ {height, width, 1}, {width, 1, 1}, "|u1",reinterpret_cast<size_t>(decoder->GetStream()),(data + 2 * (width * height)), false });//todo: data+width*height assumes both planes are contiguous. Actual NVENC allocation can have padding?
+                    self->decoder->UnmapFrame(reinterpret_cast<CUdeviceptr>(ptr));
                 }
-                case Pixel_Format_YUV444_16Bit:
+                catch (const std::exception& e)
                 {
-                    frame.views.push_back(CAIMemoryView{ {height, width, 1}, {width, 1, 1}, "|u2",reinterpret_cast<size_t>(decoder->GetStream()) ,(data), false });
-                    frame.views.push_back(CAIMemoryView{ {height, width, 1}, {width, 1, 1}, "|u2",reinterpret_cast<size_t>(decoder->GetStream()),(data + 2 * (width * height)), false });//todo: data+width*height assumes both planes are contiguous. Actual NVENC allocation can have padding?
-                    frame.views.push_back(CAIMemoryView{ {height, width, 1}, {width, 1, 1}, "|u2",reinterpret_cast<size_t>(decoder->GetStream()),(data + 4 * (width * height)), false });//todo: data+width*height assumes both planes are contiguous. Actual NVENC allocation can have padding?
+                    std::cerr << e.what() << std::endl;
                 }
-                
-            }
-            
-            return frame;
-        });
+            });
+        frames.push_back(GetMappedDecodedFrame(data, pitch, timestamp, surface));
+        frames.back().decode_latency_ms = latencyNs / 1.0e6;
+        frames.back().decode_status = ToDecodeStatus(decodeStatus);
+        SetFrameSEI(frames.back());
+    }
     return frames;
 }
 
+std::vector<DecodedFrame> PyNvDecoder::Decode(const PacketData packetData)
+{
+    // Frames released by other threads return to the pool, or free up surfaces, while the decoder waits for one
+    py::gil_scoped_release release;
+    return DecodeFrames(packetData);
+}
+
+std::vector<DecodedFrame> PyNvDecoder::DecodeFrames(const PacketData& packetData)
+{
+    NVTX_SCOPED_RANGE("py::decode")
+    if (decoder->IsZeroCopyOutput())
+    {
+        return DecodeZeroCopy(packetData);
+    }
+    std::vector<DecodedFrame> frames;
+    int numFrames = 0;
+    SetTimeBase(packetData);
+    numFrames = decoder->Decode((uint8_t*)packetData.bsl_data, packetData.bsl, m_nDecodeFlags, packetData.pts);
+
+    auto self = shared_from_this();
+    for (int i = 0; i < numFrames; i++)
+    {
+        int64_t timestamp = 0, latencyNs = 0;
+        cuvidDecodeStatus decodeStatus = cuvidDecodeStatus_Invalid;
+        uint8_t* pFrame = decoder->GetLockedFrame(&timestamp, &decodeStatus, &latencyNs, &m_sei);
+
+        // The frame goes back to the pool once the last frame, view or DLPack capsule referring to it is gone,
+        // so later Decode calls never overwrite it
+        std::shared_ptr<void> lease(pFrame, [self](void* ptr)
+            {
+                self->decoder->UnlockFrame(static_cast<uint8_t*>(ptr));
+            });
+        frames.push_back(GetDecodedFrame((CUdeviceptr)pFrame, timestamp, lease));
+        frames.back().decode_latency_ms = latencyNs / 1.0e6;
+        frames.back().decode_status = ToDecodeStatus(decodeStatus);
+        SetFrameSEI(frames.back());
+    }
+    return frames;
+}
+
+static CUVIDDECODECAPS GetDecoderCaps(int gpuid, cudaVideoCodec codec, cudaVideoChromaFormat chromaFormat, int bitDepth)
+{
+    ck(cuInit(0));
+    int nGpu = 0;
+    ck(cuDeviceGetCount(&nGpu));
+    if (gpuid < 0 || gpuid >= nGpu) {
+        std::ostringstream err;
+        err << "GPU ordinal out of range. Should be within [" << 0 << ", " << nGpu - 1 << "]" << std::endl;
+        throw std::invalid_argument(err.str());
+    }
+    if (bitDepth < 8) {
+        throw std::invalid_argument("bitdepth must be at least 8");
+    }
+
+    // cuvid is loaded once for capability queries made without a decoder
+    static CuvidFunctions api{};
+    static const char* err = loadCuvidSymbols(&api,
+#ifdef _WIN32
+        "nvcuvid.dll");
+#else
+        "libnvcuvid.so.1");
+#endif
+    if (err) {
+        throw std::runtime_error(std::string(err) + ": could not load the NVIDIA video decoder library");
+    }
+
+    CUdevice cuDevice = 0;
+    ck(cuDeviceGet(&cuDevice, gpuid));
+    py::gil_scoped_release release;
+    return NvDecoder::GetDecoderCaps(api, cuDevice, NULL, codec, chromaFormat, bitDepth - 8);
+}
+
 void Init_PyNvDecoder(py::module& m)
 {
     py::enum_<cudaVideoCodec>(m, "cudaVideoCodec", py::module_local())
@@ -219,13 +596,91 @@ void Init_PyNvDecoder(py::module& m)
         .ENUM_VALUE(cudaVideoSurfaceFormat, YUV444)
         .ENUM_VALUE(cudaVideoSurfaceFormat, YUV444_16Bit);
 
+    py::enum_<cudaVideoChromaFormat>(m, "cudaVideoChromaFormat", py::module_local())
+        .ENUM_VALUE(cudaVideoChromaFormat, Monochrome)
+        .value("YUV420", cudaVideoChromaFormat_420)
+        .value("YUV422", cudaVideoChromaFormat_422)
+        .value("YUV444", cudaVideoChromaFormat_444);
+
     py::enum_<Pixel_Format>(m, "Pixel_Format", py::module_local())
         .ENUM_VALUE(Pixel_Format, NV12)
         .ENUM_VALUE(Pixel_Format, YUV444)
         .ENUM_VALUE(Pixel_Format, P016)
-        .ENUM_VALUE(Pixel_Format, YUV444_16Bit);
+        .ENUM_VALUE(Pixel_Format, YUV444_16Bit)
+        .ENUM_VALUE(Pixel_Format, NV16)
+        .ENUM_VALUE(Pixel_Format, P216);
+
+    // ERROR is a macro in the Windows headers, so the names are not stringified through ENUM_VALUE
+    py::enum_<Decode_Status>(m, "Decode_Status", py::module_local())
+        .value("UNKNOWN", Decode_Status_UNKNOWN)
+        .value("OK", Decode_Status_OK)
+        .value("ERROR", Decode_Status_ERROR)
+        .value("CONCEALED", Decode_Status_CONCEALED);
+
+    py::enum_<Decode_Mode>(m, "Decode_Mode", py::module_local())
+        .ENUM_VALUE(Decode_Mode, FULL)
+        .ENUM_VALUE(Decode_Mode, REFERENCE_ONLY)
+        .ENUM_VALUE(Decode_Mode, KEYFRAME_ONLY);
+
+    py::enum_<Timestamp_Unit>(m, "Timestamp_Unit", py::module_local())
+        .ENUM_VALUE(Timestamp_Unit, NATIVE)
+        .ENUM_VALUE(Timestamp_Unit, NANOSECONDS)
+        .ENUM_VALUE(Timestamp_Unit, MICROSECONDS)
+        .ENUM_VALUE(Timestamp_Unit, MILLISECONDS);
+
+
+    m.def(
+        "GetDecoderCaps",
+        [](int gpuid, cudaVideoCodec codec, cudaVideoChromaFormat chromaformat, int bitdepth)
+        {
+            CUVIDDECODECAPS decodecaps = GetDecoderCaps(gpuid, codec, chromaformat, bitdepth);
+            std::map<std::string, int> caps;
+            caps["supported"] = decodecaps.bIsSupported;
+            caps["max_width"] = decodecaps.nMaxWidth;
+            caps["max_height"] = decodecaps.nMaxHeight;
+            caps["max_mb_count"] = decodecaps.nMaxMBCount;
+            caps["min_width"] = decodecaps.nMinWidth;
+            caps["min_height"] = decodecaps.nMinHeight;
+            caps["output_format_mask"] = decodecaps.nOutputFormatMask;
+            return caps;
+        },
+        py::arg("gpuid") = 0,
+        py::arg("codec") = cudaVideoCodec::cudaVideoCodec_H264,
+        py::arg("chromaformat") = cudaVideoChromaFormat_420,
+        py::arg("bitdepth") = 8,
+        R"pbdoc(
+        Returns the decoder capabilities of a GPU. The driver is queried once per process for each GPU, codec,
+        chroma format and bit depth; decoders share the same cache.
+        :param gpuid: GPU Id
+        :param codec, chromaformat, bitdepth: format of the bitstream
+        :return: dictionary with supported, max_width, max_height, max_mb_count, min_width, min_height
+                 and output_format_mask (bit n set if cudaVideoSurfaceFormat n is supported)
+    )pbdoc");
+
+    m.def(
+        "IsDecodeSupported",
+        [](unsigned int width, unsigned int height, int gpuid, cudaVideoCodec codec, cudaVideoChromaFormat chromaformat, int bitdepth)
+        {
+            CUVIDDECODECAPS decodecaps = GetDecoderCaps(gpuid, codec, chromaformat, bitdepth);
+            // same checks as done by the decoder at the sequence header
+            return decodecaps.bIsSupported && width <= decodecaps.nMaxWidth && height <= decodecaps.nMaxHeight
+                && width >= decodecaps.nMinWidth && height >= decodecaps.nMinHeight
+                && (width >> 4) * (height >> 4) <= decodecaps.nMaxMBCount;
+        },
+        py::arg("width"),
+        py::arg("height"),
+        py::arg("gpuid") = 0,
+        py::arg("codec") = cudaVideoCodec::cudaVideoCodec_H264,
+        py::arg("chromaformat") = cudaVideoChromaFormat_420,
+        py::arg("bitdepth") = 8,
+        R"pbdoc(
+        Checks a stream against the cached decoder capabilities of a GPU before opening a decoder
+        :param width, height: coded size of the bitstream
+        :param gpuid: GPU Id
+        :param codec, chromaformat, bitdepth: format of the bitstream
+        :return: True if the GPU can decode the stream
+    )pbdoc");
 
-    
     m.def(
         "CreateDecoder",
         [](
@@ -236,7 +691,7 @@ void Init_PyNvDecoder(py::module& m)
             bool usedevicememory
             )
         {
-            return std::make_shared<PyNvDecoder>(0, codec, cudacontext, cudastream, usedevicememory, false);
+            return std::make_shared<PyNvDecoder>(gpuid, codec, cudacontext, cudastream, usedevicememory, false);
         },
 
         py::arg("gpuid") = 0,
@@ -247,11 +702,12 @@ void Init_PyNvDecoder(py::module& m)
             R"pbdoc(
         Initialize decoder with set of particular
         parameters
-        :param gpuid: GPU Id
+        :param gpuid: GPU Id. Ignored when a CUDA context is passed; otherwise the current context is used if it is on this GPU, else its primary context
         :param codec : Video Codec
         :param context : CUDA context
         :param stream : CUDA Stream
-        :param use_device_memory : decoder output surface is in device memory if true else on host memory
+        :param use_device_memory : decoder output surface is in device memory if true else on host memory.
+                                   Host frames are pageable, as with pinnedhostmemory=0 in the full overload
     )pbdoc"
             )
         .def(
@@ -262,10 +718,37 @@ void Init_PyNvDecoder(py::module& m)
                 size_t cudacontext,
                 size_t cudastream,
                 bool usedevicememory,
-                bool enableasyncallocations
+                bool enableasyncallocations,
+                bool zerocopy,
+                bool waitforfreesurface,
+                unsigned int maxpoolframes,
+                bool blockonpool,
+                Timestamp_Unit timestampunit,
+                int cropleft,
+                int croptop,
+                int cropright,
+                int cropbottom,
+                int resizewidth,
+                int resizeheight,
+                unsigned int numoutputsurfaces,
+                unsigned int extradecodesurfaces,
+                int maxdisplaydelay,
+                bool lowlatency,
+                int preallocateframes,
+                std::shared_ptr<PyNvMemoryPool> mempool,
+                bool extractsei,
+                std::vector<int> seitypes,
+                bool droperrorframes,
+                bool dropconcealedframes,
+                bool pinnedhostmemory,
+                bool pitchedframes,
+                Decode_Mode decodemode
                 )
             {
-                return std::make_shared<PyNvDecoder>(0, codec, cudacontext, cudastream, true, enableasyncallocations);
+                return std::make_shared<PyNvDecoder>(gpuid, codec, cudacontext, cudastream, usedevicememory, enableasyncallocations, zerocopy, waitforfreesurface,
+                    maxpoolframes, blockonpool, timestampunit, Rect{ cropleft, croptop, cropright, cropbottom }, Dim{ resizewidth, resizeheight },
+                    numoutputsurfaces, extradecodesurfaces, maxdisplaydelay, lowlatency, preallocateframes, mempool, extractsei, seitypes, droperrorframes, dropconcealedframes,
+                    pinnedhostmemory, pitchedframes, decodemode);
             },
 
             py::arg("gpuid") = 0,
@@ -274,23 +757,105 @@ void Init_PyNvDecoder(py::module& m)
                 py::arg("cudastream") = 0,
                 py::arg("usedevicememory") = 1,
                 py::arg("enableasyncallocations") = 1,
+                py::arg("zerocopy") = 0,
+                py::arg("waitforfreesurface") = 0,
+                py::arg("maxpoolframes") = 0,
+                py::arg("blockonpool") = 0,
+                py::arg("timestampunit") = Timestamp_Unit_NATIVE,
+                py::arg("cropleft") = 0,
+                py::arg("croptop") = 0,
+                py::arg("cropright") = 0,
+                py::arg("cropbottom") = 0,
+                py::arg("resizewidth") = 0,
+                py::arg("resizeheight") = 0,
+                py::arg("numoutputsurfaces") = 2,
+                py::arg("extradecodesurfaces") = 0,
+                py::arg("maxdisplaydelay") = -1,
+                py::arg("lowlatency") = 0,
+                py::arg("preallocateframes") = 0,
+                py::arg("mempool") = nullptr,
+                py::arg("extractsei") = 0,
+                py::arg("seitypes") = std::vector<int>(),
+                py::arg("droperrorframes") = 0,
+                py::arg("dropconcealedframes") = 0,
+                py::arg("pinnedhostmemory") = 0,
+                py::arg("pitchedframes") = 0,
+                py::arg("decodemode") = Decode_Mode_FULL,
 
                 R"pbdoc(
         Initialize decoder with set of particular
         parameters
-        :param gpuid: GPU Id
+        :param gpuid: GPU Id. Ignored when a CUDA context is passed; otherwise the current context is used if it is on this GPU, else its primary context
         :param codec : Video Codec
         :param context : CUDA context
         :param stream : CUDA Stream
         :param use_device_memory : decoder output surface is in device memory if true else on host memory
+        :param zerocopy : decoded frames point into the mapped decoder output surfaces instead of being copied.
+                          A surface is released when the frame, its views and DLPack capsules are gone
+        :param waitforfreesurface : in zero-copy mode, block Decode until a surface is released when the application holds
+                                    numoutputsurfaces frames instead of raising an error
+        :param maxpoolframes : maximum number of decoded frames allocated by the decoder, 0 for no limit. Decode only parses
+                               a packet while fewer frames are held; frames a single call outputs beyond the limit are
+                               freed when released. A decoded frame returns to the pool when the frame, its views and
+                               DLPack capsules are gone
+        :param blockonpool : block Decode until a decoded frame returns to the pool when the limit is reached
+                             instead of raising an error
+        :param timestampunit : unit of DecodedFrame.timestamp. NATIVE keeps the time base of the demuxed stream,
+                               the other units rescale it using the time base carried by PacketData
+        :param cropleft, croptop, cropright, cropbottom : area of the decoded picture output by NVDEC, disabled if right or bottom is 0
+        :param resizewidth, resizeheight : size NVDEC scales the (cropped) picture to, disabled if 0.
+                                           Crop and resize are done by the decoder post-processor without an extra copy
+        :param numoutputsurfaces : number of decoder output surfaces that can be mapped at the same time. In zero-copy mode,
+                                   Decode only parses a packet while fewer frames are held. At most 64; in zero-copy mode
+                                   the session also needs one per decode surface, and the total must not exceed 64
+        :param extradecodesurfaces : decode surfaces allocated on top of the minimum required by the stream
+        :param maxdisplaydelay : frames the parser buffers before display. Higher values let parsing run ahead of decoding
+                                 at the cost of latency. -1 selects the default of 1
+        :param lowlatency : output every picture as soon as it is decoded, with no display delay. Each packet must hold
+                            one complete picture and the stream must not reorder frames (no B-frames)
+        :param preallocateframes : decoded frames allocated at the sequence header instead of on first use, capped by maxpoolframes.
+                                   0 allocates on demand, -1 allocates one frame per decode surface.
+                                   Frames are kept when the resolution decreases and only reallocated when it grows
+        :param mempool : PyNvMemoryPool the decoded frames are allocated from, on the GPU of the decoder. Requires enableasyncallocations.
+                         None uses the current pool of the GPU. With enableasyncallocations and no cudastream,
+                         the decoder copies and frees frames on a stream of its own instead of the NULL stream
+        :param extractsei : attach the SEI messages of each frame to DecodedFrame.sei_messages
+        :param seitypes : SEI payload types kept when extractsei is set, all types if empty. Other types are skipped
+                          by the parser callback, e.g. [5, 136] for user data unregistered and time code
+        :param droperrorframes : drop frames decoded with an error before they are copied. DecodedFrame.decode_status
+                                 reports the status of the frames that are output
+        :param dropconcealedframes : drop frames whose decode errors were concealed
+        :param pinnedhostmemory : with usedevicememory=0, allocate the frames in page-locked host memory. The copies
+                                  overlap with decoding and DecodedFrame.numpy() maps the frame without copying it.
+                                  Off by default, as with the basic overload, since page-locked memory is a limited
+                                  system resource
+        :param pitchedframes : allocate device frames with a row pitch suited to coalesced memory access. Views and
+                               DLPack tensors carry the pitch in their strides
+        :param decodemode : FULL decodes every picture. REFERENCE_ONLY skips the pictures no other picture refers to
+                            and KEYFRAME_ONLY decodes intra pictures only, e.g. for thumbnails. Skipped pictures are
+                            parsed but neither decoded nor output
     )pbdoc"
                 )
         ;
    
     ExternalBuffer::Export(m);
 
+    py::class_<SEIMessage, std::shared_ptr<SEIMessage>>(m, "SEIMessage")
+        .def_readonly("type", &SEIMessage::type)
+        .def_property_readonly("payload", [](const SEIMessage& self) { return py::bytes(self.payload); })
+        .def_readonly("timecode", &SEIMessage::timecode)
+        .def("__repr__",
+            [](const SEIMessage& self)
+            {
+                return "<SEIMessage [type=" + std::to_string(self.type) + ", size=" + std::to_string(self.payload.size()) + "]>";
+            });
+
     py::class_<DecodedFrame, std::shared_ptr<DecodedFrame>>(m, "DecodedFrame")
         .def_readonly("timestamp", &DecodedFrame::timestamp)
+        .def_readonly("timestamp_seconds", &DecodedFrame::timestamp_seconds)
+        .def_readonly("decode_latency_ms", &DecodedFrame::decode_latency_ms)
+        .def_readonly("decode_status", &DecodedFrame::decode_status)
+        .def_readonly("sei_messages", &DecodedFrame::sei_messages)
         .def_readonly("format", &DecodedFrame::format)
         .def("__repr__",
             [](std::shared_ptr<DecodedFrame>& self)
@@ -321,6 +886,12 @@ void Init_PyNvDecoder(py::module& m)
                 case Pixel_Format_YUV444_16Bit:
                     framesize = width * height * 6;
                     break;
+                case Pixel_Format_NV16:
+                    framesize = width * height * 2;
+                    break;
+                case Pixel_Format_P216:
+                    framesize = width * height * 4;
+                    break;
                 default:
                     break;
                 }
@@ -338,6 +909,39 @@ void Init_PyNvDecoder(py::module& m)
             return underlying views which implement CAI
             :param None: None
             )pbdoc")
+        .def("numpy",
+            [](std::shared_ptr<DecodedFrame>& self) {
+                if (!self->host_memory)
+                {
+                    throw std::invalid_argument("numpy() needs a frame in host memory, create the decoder with usedevicememory=0");
+                }
+                const CAIMemoryView& luma = self->views.at(0);
+                size_t height = luma.shape.at(0);
+                size_t width = luma.shape.at(1);
+                size_t rows = height * 3 / 2;
+                if (self->format == Pixel_Format_YUV444 || self->format == Pixel_Format_YUV444_16Bit)
+                {
+                    rows = height * 3;
+                }
+                else if (self->format == Pixel_Format_NV16 || self->format == Pixel_Format_P216)
+                {
+                    rows = height * 2;
+                }
+                py::dtype dtype = luma.typestr == "|u2" ? py::dtype::of<uint16_t>() : py::dtype::of<uint8_t>();
+                size_t itemsize = dtype.itemsize();
+                // The array keeps the frame out of the pool until it is garbage collected
+                py::capsule base(new std::shared_ptr<void>(luma.owner), [](void* owner)
+                    {
+                        delete static_cast<std::shared_ptr<void>*>(owner);
+                    });
+                return py::array(dtype, std::vector<py::ssize_t>{ py::ssize_t(rows), py::ssize_t(width) },
+                    std::vector<py::ssize_t>{ py::ssize_t(width * itemsize), py::ssize_t(itemsize) },
+                    reinterpret_cast<void*>(luma.data), base);
+            },
+            R"pbdoc(
+            return the planes of a frame decoded to host memory as a 2D numpy array, without copying the frame
+            :param None: None
+            )pbdoc")
          .def("nvcv_image",
              [](std::shared_ptr<DecodedFrame>& self) {
                  switch (self->format)
@@ -349,8 +953,14 @@ void Init_PyNvDecoder(py::module& m)
                          size_t height = self->views.at(0).shape[0] * 1.5;
                          CUdeviceptr data = self->views.at(0).data;
                          CUstream stream = self->views.at(0).stream;
+                         auto owner = self->views.at(0).owner;
+                         auto deviceType = self->views.at(0).deviceType;
+                         auto deviceId = self->views.at(0).deviceId;
                          self->views.clear();
                          self->views.push_back(CAIMemoryView{ { height, width, 1}, {width, 2, 1}, "|u1", reinterpret_cast<size_t>(stream),(data), false }); //hack for cvcuda tensor represenation
+                         self->views.back().owner = owner;
+                         self->views.back().deviceType = deviceType;
+                         self->views.back().deviceId = deviceId;
                      }
                      break;
                      case Pixel_Format_YUV444:
@@ -360,8 +970,14 @@ void Init_PyNvDecoder(py::module& m)
                          size_t height = self->views.at(0).shape[0] * 3;
                          CUdeviceptr data = self->views.at(0).data;
                          CUstream stream = self->views.at(0).stream;
+                         auto owner = self->views.at(0).owner;
+                         auto deviceType = self->views.at(0).deviceType;
+                         auto deviceId = self->views.at(0).deviceId;
                          self->views.clear();
                          self->views.push_back(CAIMemoryView{ { height, width, 1}, {width, 3, 1}, "|u1", reinterpret_cast<size_t>(stream),(data), false }); //hack for cvcuda tensor represenation
+                         self->views.back().owner = owner;
+                         self->views.back().deviceType = deviceType;
+                         self->views.back().deviceId = deviceId;
                      }
                 break;
              default:
@@ -389,11 +1005,13 @@ void Init_PyNvDecoder(py::module& m)
                  return self->extBuf->dlpack(stream);
                     }, py::arg("stream") = NULL, "Export the buffer as a DLPack tensor")
              .def("__dlpack_device__", [](std::shared_ptr<DecodedFrame>& self) {
-                        //DLDevice ctx;
-                        //ctx.device_type = DLDeviceType::kDLCUDA;
-                        //ctx.device_id = 0;
-                        return py::make_tuple(py::int_(static_cast<int>(DLDeviceType::kDLCUDA)),
-                               py::int_(static_cast<int>(0)));
+                        if (self->views.empty())
+                        {
+                            return py::make_tuple(py::int_(static_cast<int>(kDLCUDA)), py::int_(0));
+                        }
+                        const CAIMemoryView& view = self->views.at(0);
+                        return py::make_tuple(py::int_(static_cast<int>(view.deviceType)),
+                               py::int_(view.deviceId));
                  }, "Get the device associated with the buffer")
             
             
@@ -424,6 +1042,11 @@ void Init_PyNvDecoder(py::module& m)
                         .def_property_readonly("__cuda_array_interface__",
                             [](std::shared_ptr<CAIMemoryView>& self)
                             {
+                                if (self->deviceType == kDLCPU)
+                                {
+                                    // pageable host memory can't be accessed by CUDA kernels
+                                    throw py::attribute_error("The plane is in pageable host memory, use __dlpack__ or DecodedFrame.numpy()");
+                                }
                                 py::dict dict;
                                 dict["version"] = 3;
                                 dict["shape"] = self->shape;
@@ -431,9 +1054,25 @@ void Init_PyNvDecoder(py::module& m)
                                 dict["typestr"] = self->typestr;
                                 dict["stream"] = self->stream == 0 ? int(size_t(self->stream)) : 2;
                                 dict["data"] = std::make_pair(self->data, false);
-                                dict["gpuIdx"] = 0;  // TODO
+                                dict["gpuIdx"] = self->deviceId;
                                 return dict;
-                            });
+                            })
+                        .def("__dlpack__",
+                            [](std::shared_ptr<CAIMemoryView>& self, py::object stream)
+                            {
+                                // One tensor per plane, with the pitch of the plane as row stride
+                                auto buffer = std::make_shared<ExternalBuffer>();
+                                buffer->LoadDLPack(self->shape, self->stride, self->typestr, reinterpret_cast<size_t>(self->stream),
+                                    self->data, self->readOnly, self->deviceType, self->deviceId);
+                                buffer->SetOwner(self->owner);
+                                return buffer->dlpack(stream);
+                            }, py::arg("stream") = NULL, "Export the plane as a DLPack tensor")
+                        .def("__dlpack_device__",
+                            [](std::shared_ptr<CAIMemoryView>& self)
+                            {
+                                return py::make_tuple(py::int_(static_cast<int>(self->deviceType)),
+                                    py::int_(self->deviceId));
+                            }, "Get the device associated with the plane");
 
 
                     py::class_<PyNvDecoder, shared_ptr<PyNvDecoder>>(m, "PyNvDecoder", py::module_local())
@@ -472,6 +1111,112 @@ void Init_PyNvDecoder(py::module& m)
              Decodes bistream data in Packet into uncompressed data 
             :param PacketData: PacketData Structure
             :return: count of the decoded frames
+    )pbdoc"
+                                                )
+                                        .def(
+                                            "GetNumMappedFrames",
+                                            [](std::shared_ptr<PyNvDecoder>& dec)
+                                            {
+                                                return dec->GetNumMappedFrames();
+                                            }, R"pbdoc(
+            Returns the number of decoder output surfaces held by zero-copy frames
+            :param None
+            :return: count of the mapped surfaces
+    )pbdoc"
+                                                )
+                                        .def(
+                                            "SetCropResize",
+                                            [](std::shared_ptr<PyNvDecoder>& dec, int cropleft, int croptop, int cropright, int cropbottom,
+                                                int resizewidth, int resizeheight)
+                                            {
+                                                dec->SetCropResize(Rect{ cropleft, croptop, cropright, cropbottom }, Dim{ resizewidth, resizeheight });
+                                            },
+                                            py::arg("cropleft") = 0,
+                                            py::arg("croptop") = 0,
+                                            py::arg("cropright") = 0,
+                                            py::arg("cropbottom") = 0,
+                                            py::arg("resizewidth") = 0,
+                                            py::arg("resizeheight") = 0,
+                                            R"pbdoc(
+            Changes the area output by NVDEC and the size it is scaled to.
+            The change applies from the next sequence header, usually the next key frame.
+            Zero values disable crop or resize
+            :param cropleft, croptop, cropright, cropbottom: crop rectangle
+            :param resizewidth, resizeheight: output size
+    )pbdoc"
+                                                )
+                                        .def(
+                                            "SetDecodeMode",
+                                            [](std::shared_ptr<PyNvDecoder>& dec, Decode_Mode decodemode)
+                                            {
+                                                dec->SetDecodeMode(decodemode);
+                                            },
+                                            py::arg("decodemode"),
+                                            R"pbdoc(
+            Selects the pictures that are decoded and output, from the next picture on.
+            Pair KEYFRAME_ONLY with PyNvDemuxer.SetKeyFramesOnly to skip parsing the other packets as well.
+            :param decodemode: FULL, REFERENCE_ONLY or KEYFRAME_ONLY
+    )pbdoc"
+                                                )
+                                        .def(
+                                            "Reset",
+                                            [](std::shared_ptr<PyNvDecoder>& dec, cudaVideoCodec codec)
+                                            {
+                                                dec->Reset(codec);
+                                            },
+                                            py::arg("codec"),
+                                            R"pbdoc(
+            Prepares the decoder for a new bitstream without recreating it. Frames not returned yet are dropped,
+            decoded frames still held by the application stay valid.
+            The decoder session and its frames are reused when the new bitstream has the same codec, chroma format
+            and bit depth and fits the maximum size of the session, otherwise the session is recreated
+            at the first sequence header. Zero-copy frames must be released before the call.
+            :param codec: codec of the new bitstream
+    )pbdoc"
+                                                )
+                                        .def(
+                                            "GetDecodeStats",
+                                            [](std::shared_ptr<PyNvDecoder>& dec)
+                                            {
+                                                return dec->GetDecodeStats();
+                                            }, R"pbdoc(
+            Returns the decode status counters
+            :param None
+            :return: dictionary with errors, concealed, dropped_frames, reconfigurations and skipped_pictures
+    )pbdoc"
+                                                )
+                                        .def(
+                                            "GetSessionStats",
+                                            [](std::shared_ptr<PyNvDecoder>& dec)
+                                            {
+                                                return dec->GetSessionStats();
+                                            }, R"pbdoc(
+            Returns the number of times Reset() reused and recreated the decoder session
+            :param None
+            :return: dictionary with reuses and recreations
+    )pbdoc"
+                                                )
+                                        .def(
+                                            "GetSurfaceConfig",
+                                            [](std::shared_ptr<PyNvDecoder>& dec)
+                                            {
+                                                return dec->GetSurfaceConfig();
+                                            }, R"pbdoc(
+            Returns the surface configuration of the decoder
+            :param None
+            :return: dictionary with output_surfaces, decode_surfaces (0 before the first sequence header) and max_display_delay
+    )pbdoc"
+                                                )
+                                        .def(
+                                            "GetFramePoolStats",
+                                            [](std::shared_ptr<PyNvDecoder>& dec)
+                                            {
+                                                return dec->GetFramePoolStats();
+                                            }, R"pbdoc(
+            Returns the decoded frame pool counters
+            :param None
+            :return: dictionary with hits, misses, in_use, high_water, allocated (frames currently allocated),
+                     allocations and frees (totals since creation) and preallocated
     )pbdoc"
                                                 )
                                         .def(
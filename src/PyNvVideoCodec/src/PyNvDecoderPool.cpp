@@ -0,0 +1,192 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PyNvDecoderPool.hpp"
+
+using namespace std;
+
+namespace py = pybind11;
+
+PyNvDecoderPool::PyNvDecoderPool(int gpuid, unsigned int maxIdle, const Factory& factory)
+    : m_state(std::make_shared<State>()), m_nGpuId(gpuid), m_factory(factory)
+{
+    ck(cuInit(0));
+    int nGpu = 0;
+    ck(cuDeviceGetCount(&nGpu));
+    if (gpuid < 0 || gpuid >= nGpu) {
+        std::ostringstream err;
+        err << "GPU ordinal out of range. Should be within [" << 0 << ", " << nGpu - 1 << "]" << std::endl;
+        throw std::invalid_argument(err.str());
+    }
+
+    CUdevice cuDevice = 0;
+    CUcontext cuContext = NULL;
+    ck(cuDeviceGet(&cuDevice, gpuid));
+    ck(cuDevicePrimaryCtxRetain(&cuContext, cuDevice));
+    m_state->context.reset(cuContext, [cuDevice](CUctx_st*) { cuDevicePrimaryCtxRelease(cuDevice); });
+    m_state->nMaxIdle = maxIdle;
+}
+
+std::shared_ptr<PyNvDecoder> PyNvDecoderPool::Wrap(std::shared_ptr<PyNvDecoder> decoder)
+{
+    std::weak_ptr<State> weakState = m_state;
+    PyNvDecoder* pDecoder = decoder.get();
+    return std::shared_ptr<PyNvDecoder>(pDecoder, [weakState, decoder](PyNvDecoder*) mutable {
+        // Runs once the application and all decoded frames have dropped the decoder
+        auto state = weakState.lock();
+        NvDecoder* pNvDecoder = decoder->GetDecoder();
+        if (!state || !pNvDecoder->HasDecoderSession())
+        {
+            return;
+        }
+        Key key(pNvDecoder->GetCodec(), pNvDecoder->GetChromaFormat(), pNvDecoder->GetBitDepth());
+        std::lock_guard<std::mutex> lock(state->mtx);
+        auto& idle = state->idle[key];
+        if (idle.size() < state->nMaxIdle)
+        {
+            idle.push_back(std::move(decoder));
+        }
+    });
+}
+
+std::shared_ptr<PyNvDecoder> PyNvDecoderPool::Acquire(cudaVideoCodec codec, cudaVideoChromaFormat chromaFormat, int bitDepth)
+{
+    std::shared_ptr<PyNvDecoder> decoder;
+    {
+        std::lock_guard<std::mutex> lock(m_state->mtx);
+        auto it = m_state->idle.find(Key(codec, chromaFormat, bitDepth));
+        if (it != m_state->idle.end() && !it->second.empty())
+        {
+            decoder = std::move(it->second.back());
+            it->second.pop_back();
+            m_state->nHit++;
+        }
+        else
+        {
+            m_state->nMiss++;
+        }
+    }
+
+    if (decoder)
+    {
+        decoder->Reset(codec);
+    }
+    else
+    {
+        decoder = m_factory(m_nGpuId, reinterpret_cast<size_t>(m_state->context.get()), codec);
+        // the decoder keeps the primary context retained after the pool is gone
+        decoder->SetContextOwner(m_state->context);
+    }
+    return Wrap(std::move(decoder));
+}
+
+std::map<std::string, int> PyNvDecoderPool::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_state->mtx);
+    std::map<std::string, int> stats;
+    int nIdle = 0;
+    for (const auto& idle : m_state->idle)
+    {
+        nIdle += (int)idle.second.size();
+    }
+    stats["idle"] = nIdle;
+    stats["hits"] = m_state->nHit;
+    stats["misses"] = m_state->nMiss;
+    return stats;
+}
+
+void PyNvDecoderPool::Clear()
+{
+    std::map<Key, std::vector<std::shared_ptr<PyNvDecoder>>> idle;
+    {
+        std::lock_guard<std::mutex> lock(m_state->mtx);
+        idle.swap(m_state->idle);
+    }
+    // decoders are destroyed outside of the lock
+    py::gil_scoped_release release;
+    idle.clear();
+}
+
+void Init_PyNvDecoderPool(py::module& m)
+{
+    py::class_<PyNvDecoderPool, shared_ptr<PyNvDecoderPool>>(m, "PyNvDecoderPool", py::module_local())
+        .def(py::init(
+            // every option of CreateDecoder is forwarded, so pooled decoders never miss one
+            [createDecoder = py::object(m.attr("CreateDecoder"))](int gpuid, unsigned int maxidledecoders, py::kwargs kwargs)
+            {
+                if (kwargs.contains("cudacontext") || kwargs.contains("codec"))
+                {
+                    throw std::invalid_argument("The pool selects the CUDA context and codec of its decoders");
+                }
+                // defaults of pooled decoders, which also select the CreateDecoder overload taking every option
+                if (!kwargs.contains("usedevicememory"))
+                {
+                    kwargs["usedevicememory"] = true;
+                }
+                if (!kwargs.contains("enableasyncallocations"))
+                {
+                    kwargs["enableasyncallocations"] = true;
+                }
+                return std::make_shared<PyNvDecoderPool>(gpuid, maxidledecoders,
+                    [createDecoder, kwargs](int gpuid, size_t context, cudaVideoCodec codec)
+                    {
+                        return createDecoder(py::arg("gpuid") = gpuid, py::arg("codec") = codec, py::arg("cudacontext") = context, **kwargs)
+                            .cast<std::shared_ptr<PyNvDecoder>>();
+                    });
+            }),
+            py::arg("gpuid") = 0,
+            py::arg("maxidledecoders") = 4,
+            R"pbdoc(
+                Constructor method. Creates a pool of warm decoders for workloads decoding many short bitstreams.
+                A decoder returns to the pool when it and its decoded frames are no longer referenced, and its
+                decoder session is reused by the next bitstream of the same codec, chroma format and bit depth
+                that fits its maximum size.
+                :param gpuid: GPU Id of the decoders. They share the primary context of the GPU
+                :param maxidledecoders: idle decoders kept per codec, chroma format and bit depth
+                Takes the keyword arguments of CreateDecoder except codec and cudacontext, which are set by the pool,
+                and creates every decoder with them. usedevicememory and enableasyncallocations default to 1
+            )pbdoc")
+        .def("Acquire",
+            &PyNvDecoderPool::Acquire,
+            py::arg("codec") = cudaVideoCodec::cudaVideoCodec_H264,
+            py::arg("chromaformat") = cudaVideoChromaFormat_420,
+            py::arg("bitdepth") = 8,
+            R"pbdoc(
+                Returns an idle decoder reset for a new bitstream, or a new decoder if none of this kind is idle.
+                :param codec: codec of the bitstream
+                :param chromaformat, bitdepth: expected format of the bitstream, used to find a decoder whose session can be reused
+            )pbdoc")
+        .def("GetStats",
+            &PyNvDecoderPool::GetStats,
+            R"pbdoc(
+                Returns the pool counters
+                :return: dictionary with idle, hits (acquisitions served by an idle decoder) and misses
+            )pbdoc")
+        .def("Clear",
+            &PyNvDecoderPool::Clear,
+            R"pbdoc(
+                Destroys the idle decoders
+            )pbdoc");
+}
@@ -23,6 +23,7 @@
  * DEALINGS IN THE SOFTWARE.
  */
 #include "PyNvDemuxer.hpp"
+#include <string_view>
 
 using namespace std;
 using namespace chrono;
@@ -30,9 +31,152 @@ using namespace chrono;
 namespace py = pybind11;
 
 
-PyNvDemuxer::PyNvDemuxer(const std::string& filePath)
+/**
+* @brief Reads from a contiguous Python buffer-protocol object. The object is kept alive and its buffer exported for
+* the lifetime of the provider, so the data is not copied up front; each read copies one chunk into the AVIO buffer.
+*/
+class BufferDataProvider : public FFmpegDemuxer::DataProvider
 {
-    demuxer.reset(new NvDemuxer(filePath));
+    py::buffer buffer;
+    py::buffer_info info;
+    const uint8_t* data = nullptr;
+    int64_t size = 0;
+    int64_t offset = 0;
+    bool seekable;
+
+public:
+    BufferDataProvider(py::buffer _buffer, bool _seekable) : buffer(_buffer), info(_buffer.request()), seekable(_seekable)
+    {
+        if (info.ndim > 1 || (info.ndim == 1 && info.strides[0] != info.itemsize))
+        {
+            throw std::invalid_argument("Input buffer must be contiguous and one dimensional");
+        }
+        data = static_cast<const uint8_t*>(info.ptr);
+        size = info.size * info.itemsize;
+    }
+
+    int GetData(uint8_t* pBuf, int nBuf) override
+    {
+        int64_t nRead = (std::min)((int64_t)nBuf, size - offset);
+        if (nRead <= 0)
+        {
+            return AVERROR_EOF;
+        }
+        memcpy(pBuf, data + offset, nRead);
+        offset += nRead;
+        return (int)nRead;
+    }
+
+    int64_t Seek(int64_t pos, int whence) override
+    {
+        switch (whence)
+        {
+        case AVSEEK_SIZE: return size;
+        case SEEK_SET: break;
+        case SEEK_CUR: pos += offset; break;
+        case SEEK_END: pos += size; break;
+        default: return -1;
+        }
+        if (pos < 0 || pos > size)
+        {
+            return -1;
+        }
+        offset = pos;
+        return offset;
+    }
+
+    bool IsSeekable() override { return seekable; }
+};
+
+/**
+* @brief Reads from a Python file-like object with readinto() or read(), and seek()/tell() when seekable.
+* Takes the GIL for every call since the demuxer may read from the prefetch thread.
+*/
+class FileLikeDataProvider : public FFmpegDemuxer::DataProvider
+{
+    py::object file;
+    bool hasReadInto;
+    bool seekable;
+
+public:
+    FileLikeDataProvider(py::object _file, bool _seekable) : file(_file)
+    {
+        hasReadInto = py::hasattr(file, "readinto");
+        if (!hasReadInto && !py::hasattr(file, "read"))
+        {
+            throw std::invalid_argument("Input must be a buffer or a file-like object with readinto() or read()");
+        }
+        seekable = _seekable && py::hasattr(file, "seek") && py::hasattr(file, "tell")
+            && (!py::hasattr(file, "seekable") || file.attr("seekable")().cast<bool>());
+    }
+
+    int GetData(uint8_t* pBuf, int nBuf) override
+    {
+        py::gil_scoped_acquire acquire;
+        try
+        {
+            int nRead = 0;
+            if (hasReadInto)
+            {
+                py::object result = file.attr("readinto")(py::memoryview::from_memory(pBuf, nBuf));
+                nRead = result.is_none() ? 0 : result.cast<int>();
+            }
+            else
+            {
+                py::bytes chunk = file.attr("read")(nBuf);
+                std::string_view view = chunk;
+                nRead = (int)(std::min)(view.size(), (size_t)nBuf);
+                memcpy(pBuf, view.data(), nRead);
+            }
+            return nRead > 0 ? nRead : AVERROR_EOF;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Reading demuxer input failed: " << e.what() << std::endl;
+            return AVERROR(EIO);
+        }
+    }
+
+    int64_t Seek(int64_t pos, int whence) override
+    {
+        py::gil_scoped_acquire acquire;
+        try
+        {
+            if (whence == AVSEEK_SIZE)
+            {
+                py::object current = file.attr("tell")();
+                int64_t size = file.attr("seek")(0, SEEK_END).cast<int64_t>();
+                file.attr("seek")(current, SEEK_SET);
+                return size;
+            }
+            return file.attr("seek")(pos, whence).cast<int64_t>();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Seeking demuxer input failed: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    bool IsSeekable() override { return seekable; }
+};
+
+PyNvDemuxer::PyNvDemuxer(const std::string& filePath, size_t prefetchDepth)
+{
+    demuxer.reset(new NvDemuxer(filePath, prefetchDepth));
+}
+
+PyNvDemuxer::PyNvDemuxer(std::unique_ptr<FFmpegDemuxer::DataProvider> provider, int avioBufferSize, size_t prefetchDepth)
+    : dataProvider(std::move(provider))
+{
+    demuxer.reset(new NvDemuxer(dataProvider.get(), avioBufferSize, prefetchDepth));
+}
+
+PyNvDemuxer::~PyNvDemuxer()
+{
+    // The prefetch thread may be waiting for the GIL inside a file-like provider
+    py::gil_scoped_release release;
+    demuxer.reset();
 }
 shared_ptr<PacketData> PyNvDemuxer::Demux()
 {
@@ -60,17 +204,54 @@ void Init_PyNvDemuxer(py::module& m)
 
     m.def("CreateDemuxer",
         [](
-            const std::string& filename
+            const std::string& filename,
+            size_t prefetchdepth
             )
         {
-            return std::make_shared<PyNvDemuxer>(filename);
+            return std::make_shared<PyNvDemuxer>(filename, prefetchdepth);
         },
 
         py::arg("filename"),
+        py::arg("prefetchdepth") = 0,
             R"pbdoc(
         Initialize decoder with set of particular
         parameters
         :param _filename: provided mp4 or encoded bitstream data
+        :param prefetchdepth: if non zero, a worker thread demuxes up to this many packets ahead of Demux
+    )pbdoc");
+
+    m.def("CreateStreamDemuxer",
+        [](
+            py::object source,
+            size_t prefetchdepth,
+            int aviobuffersize,
+            bool seekable
+            )
+        {
+            std::unique_ptr<FFmpegDemuxer::DataProvider> provider;
+            if (py::isinstance<py::buffer>(source))
+            {
+                provider.reset(new BufferDataProvider(source.cast<py::buffer>(), seekable));
+            }
+            else
+            {
+                provider.reset(new FileLikeDataProvider(source, seekable));
+            }
+            return std::make_shared<PyNvDemuxer>(std::move(provider), aviobuffersize, prefetchdepth);
+        },
+
+        py::arg("source"),
+        py::arg("prefetchdepth") = 0,
+        py::arg("aviobuffersize") = 8 * 1024 * 1024,
+        py::arg("seekable") = true,
+            R"pbdoc(
+        Initialize demuxer reading from memory or a file-like object instead of a file path
+        :param source: bytes, bytearray, memoryview or any contiguous buffer-protocol object holding the whole stream
+                       (not copied up front, each read copies a chunk into FFmpeg's I/O buffer),
+                       or a file-like object with readinto() or read()
+        :param prefetchdepth: if non zero, a worker thread demuxes up to this many packets ahead of Demux
+        :param aviobuffersize: size in bytes of the buffer FFmpeg reads the source into
+        :param seekable: allow seeking in the source. File-like objects also need seek() and tell()
     )pbdoc");
 
     py::class_<PacketData, shared_ptr<PacketData>>(m, "PacketData", py::module_local())
@@ -82,6 +263,8 @@ void Init_PyNvDemuxer(py::module& m)
         .def_readwrite("bsl", &PacketData::bsl)
         .def_readwrite("bsl_data", &PacketData::bsl_data)
         .def_readwrite("duration", &PacketData::duration)
+        .def_readwrite("time_base_num", &PacketData::time_base_num)
+        .def_readwrite("time_base_den", &PacketData::time_base_den)
         .def("__repr__", [](shared_ptr<PacketData> self) {
         stringstream ss;
         ss << "key:      " << self->key << "\n";
@@ -91,6 +274,7 @@ void Init_PyNvDemuxer(py::module& m)
         ss << "bsl:      " << self->bsl << "\n";
         ss << "bsl_data:      " << self->bsl_data << "\n";
         ss << "duration: " << self->duration << "\n";
+        ss << "time_base: " << self->time_base_num << "/" << self->time_base_den << "\n";
         return ss.str();
             });
     py::class_<PyNvDemuxer, shared_ptr<PyNvDemuxer>>(m, "PyNvDemuxer", py::module_local())
@@ -100,6 +284,49 @@ void Init_PyNvDemuxer(py::module& m)
         parameters
 
         :param None: None
+    )pbdoc")
+          .def_property_readonly(
+            "prefetch_queue_depth",
+            [](shared_ptr<PyNvDemuxer> self) {
+                return self->GetPrefetchQueueDepth();
+            },
+                R"pbdoc(
+            Number of packets demuxed ahead and waiting in the prefetch queue
+    )pbdoc")
+          .def_property_readonly(
+            "prefetch_bytes_buffered",
+            [](shared_ptr<PyNvDemuxer> self) {
+                return self->GetPrefetchBytes();
+            },
+                R"pbdoc(
+            Bitstream bytes held by the packets in the prefetch queue
+    )pbdoc")
+          .def_property_readonly(
+            "prefetch_stall_time",
+            [](shared_ptr<PyNvDemuxer> self) {
+                return self->GetPrefetchStallTime();
+            },
+                R"pbdoc(
+            Total time in seconds Demux waited for the prefetch thread
+    )pbdoc")
+          .def_property_readonly(
+            "skipped_packets",
+            [](shared_ptr<PyNvDemuxer> self) {
+                return self->GetSkippedPackets();
+            },
+                R"pbdoc(
+            Number of packets dropped by SetKeyFramesOnly because they were not key frames
+    )pbdoc")
+          .def(
+            "SetKeyFramesOnly",
+            [](shared_ptr<PyNvDemuxer> self, bool keyframesonly) {
+                self->SetKeyFramesOnly(keyframesonly);
+            },
+            py::arg("keyframesonly"),
+                R"pbdoc(
+            Return key frame packets only, e.g. for thumbnails, together with decodemode=KEYFRAME_ONLY on the decoder.
+            Packets already demuxed ahead by the prefetch thread are returned as they are.
+            :param keyframesonly: drop the packets that are not flagged as key frames
     )pbdoc")
           .def(
             "Width",
@@ -171,6 +398,7 @@ void Init_PyNvDemuxer(py::module& m)
                 }
                 
             },
+            py::call_guard<py::gil_scoped_release>(),
             R"pbdoc(
             gets the next element in Iterator over demuxer object
     )pbdoc")
@@ -180,6 +408,7 @@ void Init_PyNvDemuxer(py::module& m)
                 return self->Demux();
             },
             py::return_value_policy::reference,
+            py::call_guard<py::gil_scoped_release>(),
                 R"pbdoc(
         Extract single compressed video packet and sends it to application.
 
@@ -192,6 +421,7 @@ void Init_PyNvDemuxer(py::module& m)
             return self->Demux();
           },
           py::return_value_policy::reference,
+          py::call_guard<py::gil_scoped_release>(),
           R"pbdoc(
         Extract single compressed video packet and sends it to application.
 
@@ -205,12 +435,53 @@ void Init_PyNvDemuxer(py::module& m)
             return self->Seek(tmptimestamp);
              },
           py::return_value_policy::reference,
+          py::call_guard<py::gil_scoped_release>(),
           R"pbdoc(
         Seek to nearest keyframe at given timestamp, extract single compressed video packet and sends it to application.
+        With a packet index loaded, seeks to the keyframe the frame at the given timestamp has to be decoded from.
+        PacketsToSeekTarget then gives the number of packets to decode to reach that frame.
 
-        :param None: None
+        :param timestamp: timestamp in seconds
         :return: PacketData is returned
     )pbdoc")
+    .def(
+          "BuildIndex",
+          [](shared_ptr<PyNvDemuxer> self, const std::string& indexpath) {
+            self->BuildIndex(indexpath);
+             },
+          py::arg("indexpath") = "",
+          py::call_guard<py::gil_scoped_release>(),
+          R"pbdoc(
+        Scan the input once, record offset, pts, dts, size and keyframe flag of every video packet,
+        write them to a sidecar index file and use the index for subsequent seeks.
+
+        :param indexpath: path of the index file, defaults to the input path with a .nvidx suffix
+        :return: None
+    )pbdoc")
+    .def(
+          "LoadIndex",
+          [](shared_ptr<PyNvDemuxer> self, const std::string& indexpath) {
+            self->LoadIndex(indexpath);
+             },
+          py::arg("indexpath") = "",
+          R"pbdoc(
+        Load a sidecar index file written by BuildIndex and use it for subsequent seeks.
+        Raises if the index was built for a different file.
+
+        :param indexpath: path of the index file, defaults to the input path with a .nvidx suffix
+        :return: None
+    )pbdoc")
+    .def(
+          "PacketsToSeekTarget",
+          [](shared_ptr<PyNvDemuxer> self) {
+            return self->GetPacketsToSeekTarget();
+             },
+          R"pbdoc(
+        Number of packets, starting with the one returned by the last indexed Seek, to decode to reach the target frame
+
+        :param None: None
+        :return: packet count, 0 if the last seek did not use an index
+    )pbdoc")
 #ifndef DEMUX_ONLY
               .def(
                   "GetNvCodecId",
@@ -33,6 +33,7 @@
 #include <pybind11/stl.h>
 #include <pybind11/embed.h>
 #include <pybind11/cast.h>
+#include <sstream>
 
 using namespace std;
 using namespace chrono;
@@ -60,10 +61,10 @@ PyNvEncoder::PyNvEncoder(
         size_t  _cudacontext,
         size_t _cudastream,
         bool bUseCPUInputBuffer,
-        std::map<std::string, std::string> kwargs)
+        std::map<std::string, std::string> kwargs,
+        int iGPU)
 {
     NV_ENC_BUFFER_FORMAT eBufferFormat;
-    int iGPU = 0;
     CUcontext cudacontext =(CUcontext) _cudacontext;
     CUstream cudastream = (CUstream)_cudastream;
 
@@ -115,6 +116,14 @@ PyNvEncoder::PyNvEncoder(
     params.bufferFormat = eBufferFormat;
 
     cuInit(0);
+    int nGpu = 0;
+    CUDA_DRVAPI_CALL(cuDeviceGetCount(&nGpu));
+    if (iGPU < 0 || iGPU >= nGpu) {
+        std::ostringstream err;
+        err << "GPU ordinal out of range. Should be within [" << 0 << ", " << nGpu - 1 << "]" << std::endl;
+        throw std::invalid_argument(err.str());
+    }
+
     if(cudacontext)
     {
         uint32_t version = 0;
@@ -123,15 +132,25 @@ PyNvEncoder::PyNvEncoder(
     }
     else
     {
+        CUdevice cuDevice = 0;
+        CUDA_DRVAPI_CALL(cuDeviceGet(&cuDevice, iGPU));
         CUDA_DRVAPI_CALL(cuCtxGetCurrent(&cudacontext));
 	std::cout << "context fetched=" << cudacontext << std::endl;
+        if(cudacontext)
+        {
+            // the current context is only reused when it belongs to the requested GPU
+            CUdevice cuCurrentDevice = 0;
+            CUDA_DRVAPI_CALL(cuCtxGetDevice(&cuCurrentDevice));
+            if(cuCurrentDevice != cuDevice)
+            {
+                cudacontext = nullptr;
+            }
+        }
         if(!cudacontext)
         {
-            CUdevice cuDevice = 0;
-            cuDeviceGet(&cuDevice, iGPU);
-            CUDA_DRVAPI_CALL(cuCtxCreate(&cudacontext, 0, cuDevice));
-            CUDA_DRVAPI_CALL(cuCtxPopCurrent(&cudacontext));
-            m_bDestroyContext = true;
+            CUDA_DRVAPI_CALL(cuDevicePrimaryCtxRetain(&cudacontext, cuDevice));
+            m_cuDevice = cuDevice;
+            m_bReleasePrimaryContext = true;
         }
 
     }
@@ -279,6 +298,8 @@ const NvEncInputFrame* PyNvEncoder::GetEncoderInputFromCPUBuffer(py::array_t<uin
         throw std::runtime_error("Format not supported");
     }
 
+    // framedata keeps the host buffer alive while the copy runs without the GIL
+    py::gil_scoped_release release;
     NvEncoderCuda::CopyToDeviceFrame(m_CUcontext,
         (void*)srcPtr,
         srcStride,
@@ -387,6 +408,7 @@ const NvEncInputFrame* PyNvEncoder::GetEncoderInput(py::object frame)
     {
         throw std::invalid_argument("unsupported format.");
     }
+    py::gil_scoped_release release;
     NvEncoderCuda::CopyToDeviceFrame(m_CUcontext, 
         (void*) srcPtr,
         srcStride,
@@ -415,6 +437,7 @@ void PyNvEncoder::ConvertFrameNumToTimestamp(std::vector<NvEncOutputBitstream> &
         }
         packet.outputTimeStamp = found->second;
         m_mapFrameNumToTimestamp.erase(found);
+        m_nQueuedFrames--;
     }
 }
 
@@ -448,10 +471,14 @@ std::vector<NvEncOutputBitstream> PyNvEncoder::Encode(py::object _frame, std::op
         actual_timestamp = timestamp_ns.value();
     }
     m_mapFrameNumToTimestamp[picParam.inputTimeStamp] = actual_timestamp;
+    m_nQueuedFrames++;
 
     std::vector<NvEncOutputBitstream> vOutput;
-    m_encoder->EncodeFrame(vOutput, &picParam);
-    ConvertFrameNumToTimestamp(vOutput);
+    {
+        py::gil_scoped_release release;
+        m_encoder->EncodeFrame(vOutput, &picParam);
+        ConvertFrameNumToTimestamp(vOutput);
+    }
     return vOutput;
 }
 
@@ -459,8 +486,11 @@ std::vector<NvEncOutputBitstream> PyNvEncoder::Encode()
 {
     //flush the encoder
     std::vector<NvEncOutputBitstream> vOutput;
-    m_encoder->EndEncode(vOutput);
-    ConvertFrameNumToTimestamp(vOutput);
+    {
+        py::gil_scoped_release release;
+        m_encoder->EndEncode(vOutput);
+        ConvertFrameNumToTimestamp(vOutput);
+    }
     return vOutput;
 }
 
@@ -486,13 +516,13 @@ PyNvEncoder::~PyNvEncoder()
     m_width = 0;
     m_height = 0;
 
-    if(m_bDestroyContext)
+    if(m_bReleasePrimaryContext)
     {
         m_encoder.reset();
         pCUStream.reset();
 
-        CUDA_DRVAPI_CALL(cuCtxDestroy(m_CUcontext));
-        m_bDestroyContext = false;
+        CUDA_DRVAPI_CALL(cuDevicePrimaryCtxRelease(m_cuDevice));
+        m_bReleasePrimaryContext = false;
     }
 
     m_CUcontext = nullptr;
@@ -615,10 +645,19 @@ void Init_PyNvEncoder(py::module& m)
             });
 
     py::class_<PyNvEncoder, shared_ptr<PyNvEncoder>>(m, "PyNvEncoder", py::module_local())
-        .def(py::init<int, int, std::string,  size_t , size_t,  bool ,std::map<std::string,std::string>>(),
+        .def(py::init<int, int, std::string,  size_t , size_t,  bool ,std::map<std::string,std::string>, int>(),
+            py::arg("width"),
+            py::arg("height"),
+            py::arg("format"),
+            py::arg("cudacontext"),
+            py::arg("cudastream"),
+            py::arg("usecpuinputbuffer"),
+            py::arg("config"),
+            py::arg("gpuid") = 0,
             R"pbdoc(
                 Constructor method. Initialize encoder session with set of particular paramters
                 :param width, height, format, cpuinputbuffer,other-optional-params,  
+                :param gpuid: GPU Id. Ignored when a CUDA context is passed; otherwise the current context is used if it is on this GPU, else its primary context
             )pbdoc")
         .def(
              "Encode",
@@ -0,0 +1,157 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PyNvMemoryPool.hpp"
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <limits>
+#include <sstream>
+
+using namespace std;
+
+namespace py = pybind11;
+
+PyNvMemoryPool::PyNvMemoryPool(int gpuid, bool useDefaultPool, int64_t releaseThreshold,
+    bool reuseFollowEventDependencies, bool reuseAllowOpportunistic, bool reuseAllowInternalDependencies)
+    : m_nGpuId(gpuid)
+{
+    ck(cuInit(0));
+    int nGpu = 0;
+    ck(cuDeviceGetCount(&nGpu));
+    if (gpuid < 0 || gpuid >= nGpu) {
+        std::ostringstream err;
+        err << "GPU ordinal out of range. Should be within [" << 0 << ", " << nGpu - 1 << "]" << std::endl;
+        throw std::invalid_argument(err.str());
+    }
+    ck(cuDeviceGet(&m_cuDevice, gpuid));
+
+    int bMemPoolSupported = 0;
+    ck(cuDeviceGetAttribute(&bMemPoolSupported, CU_DEVICE_ATTRIBUTE_MEMORY_POOLS_SUPPORTED, m_cuDevice));
+    if (!bMemPoolSupported)
+    {
+        throw std::runtime_error("GPU " + std::to_string(gpuid) + " does not support stream-ordered memory pools");
+    }
+
+    if (useDefaultPool)
+    {
+        ck(cuDeviceGetDefaultMemPool(&m_hMemPool, m_cuDevice));
+    }
+    else
+    {
+        CUmemPoolProps props = {};
+        props.allocType = CU_MEM_ALLOCATION_TYPE_PINNED;
+        props.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+        props.location.id = m_cuDevice;
+        ck(cuMemPoolCreate(&m_hMemPool, &props));
+        m_bDestroyPool = true;
+    }
+
+    SetReleaseThreshold(releaseThreshold);
+    int value = reuseFollowEventDependencies;
+    ck(cuMemPoolSetAttribute(m_hMemPool, CU_MEMPOOL_ATTR_REUSE_FOLLOW_EVENT_DEPENDENCIES, &value));
+    value = reuseAllowOpportunistic;
+    ck(cuMemPoolSetAttribute(m_hMemPool, CU_MEMPOOL_ATTR_REUSE_ALLOW_OPPORTUNISTIC, &value));
+    value = reuseAllowInternalDependencies;
+    ck(cuMemPoolSetAttribute(m_hMemPool, CU_MEMPOOL_ATTR_REUSE_ALLOW_INTERNAL_DEPENDENCIES, &value));
+}
+
+PyNvMemoryPool::~PyNvMemoryPool()
+{
+    if (m_bDestroyPool)
+    {
+        // memory still in use by pending frees is released once they complete
+        cuMemPoolDestroy(m_hMemPool);
+    }
+}
+
+void PyNvMemoryPool::SetReleaseThreshold(int64_t releaseThreshold)
+{
+    cuuint64_t threshold = releaseThreshold < 0 ? std::numeric_limits<cuuint64_t>::max() : (cuuint64_t)releaseThreshold;
+    ck(cuMemPoolSetAttribute(m_hMemPool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &threshold));
+}
+
+void PyNvMemoryPool::Trim(size_t minBytesToKeep)
+{
+    ck(cuMemPoolTrimTo(m_hMemPool, minBytesToKeep));
+}
+
+std::map<std::string, uint64_t> PyNvMemoryPool::GetStats()
+{
+    std::map<std::string, uint64_t> stats;
+    const std::pair<const char*, CUmemPool_attribute> attributes[] = {
+        { "reserved_current", CU_MEMPOOL_ATTR_RESERVED_MEM_CURRENT },
+        { "reserved_high", CU_MEMPOOL_ATTR_RESERVED_MEM_HIGH },
+        { "used_current", CU_MEMPOOL_ATTR_USED_MEM_CURRENT },
+        { "used_high", CU_MEMPOOL_ATTR_USED_MEM_HIGH },
+    };
+    for (const auto& attribute : attributes)
+    {
+        cuuint64_t value = 0;
+        ck(cuMemPoolGetAttribute(m_hMemPool, attribute.second, &value));
+        stats[attribute.first] = value;
+    }
+    return stats;
+}
+
+void Init_PyNvMemoryPool(py::module& m)
+{
+    py::class_<PyNvMemoryPool, shared_ptr<PyNvMemoryPool>>(m, "PyNvMemoryPool", py::module_local())
+        .def(py::init<int, bool, int64_t, bool, bool, bool>(),
+            py::arg("gpuid") = 0,
+            py::arg("usedefaultpool") = 0,
+            py::arg("releasethreshold") = -1,
+            py::arg("reusefolloweventdependencies") = 1,
+            py::arg("reuseallowopportunistic") = 1,
+            py::arg("reuseallowinternaldependencies") = 1,
+            R"pbdoc(
+                Constructor method. Creates a stream-ordered memory pool for decoded frames, to be passed to CreateDecoder.
+                A pool can be shared by all decoders of its GPU.
+                :param gpuid: GPU Id of the pool
+                :param usedefaultpool: configure the default pool of the GPU, used by every decoder without a pool, instead of creating one
+                :param releasethreshold: bytes kept reserved when the pool is trimmed at synchronization, -1 keeps all of them
+                :param reusefolloweventdependencies, reuseallowopportunistic, reuseallowinternaldependencies: reuse policies of the pool
+            )pbdoc")
+        .def("SetReleaseThreshold",
+            &PyNvMemoryPool::SetReleaseThreshold,
+            py::arg("releasethreshold"),
+            R"pbdoc(
+                Sets the bytes kept reserved when the pool is trimmed at synchronization
+                :param releasethreshold: threshold in bytes, -1 keeps all the memory
+            )pbdoc")
+        .def("Trim",
+            &PyNvMemoryPool::Trim,
+            py::arg("minbytestokeep") = 0,
+            R"pbdoc(
+                Releases unused memory of the pool
+                :param minbytestokeep: bytes kept reserved
+            )pbdoc")
+        .def("GetStats",
+            &PyNvMemoryPool::GetStats,
+            R"pbdoc(
+                Returns the memory counters of the pool
+                :return: dictionary with reserved_current, reserved_high, used_current and used_high in bytes
+            )pbdoc")
+        .def_property_readonly("gpuid", &PyNvMemoryPool::GetGpuId);
+}
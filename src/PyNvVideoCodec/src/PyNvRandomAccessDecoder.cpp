@@ -0,0 +1,284 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PyNvRandomAccessDecoder.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace py = pybind11;
+
+PyNvRandomAccessDecoder::PyNvRandomAccessDecoder(const std::string& filename, int gpuid, bool useDeviceFrame,
+    const std::string& indexPath)
+{
+    m_demuxer.reset(new NvDemuxer(filename));
+    try
+    {
+        m_demuxer->LoadIndex(indexPath);
+    }
+    catch (const std::exception&)
+    {
+        m_demuxer->BuildIndex(indexPath);
+    }
+    if (m_demuxer->GetPacketIndex().Empty())
+    {
+        throw std::runtime_error("No video packets found in " + filename);
+    }
+    m_eCodec = m_demuxer->GetNvCodecId();
+    m_decoder = std::make_shared<PyNvDecoder>(gpuid, m_eCodec, 0, 0, useDeviceFrame, true);
+}
+
+PyNvRandomAccessDecoder::Request PyNvRandomAccessDecoder::MakeRequest(size_t entry, size_t slot)
+{
+    const PacketIndex& index = m_demuxer->GetPacketIndex();
+    return Request{ entry, index.GetKeyEntry(entry), index.GetDisplayTs(entry), slot };
+}
+
+void PyNvRandomAccessDecoder::SeekToKey(size_t key)
+{
+    m_nSeek++;
+    m_vPending.clear();
+    if (m_bPositioned)
+    {
+        // Pictures of the previous position still held by the decoder are dropped
+        m_decoder->GetDecoder()->Reset(m_eCodec);
+    }
+    m_pSeekPacket = m_demuxer->SeekToPacket(key);
+    m_bPositioned = true;
+    m_bFlushed = false;
+    m_nSeekKey = key;
+    m_nNextPacket = key;
+    m_nConsumedPts = INT64_MIN;
+}
+
+bool PyNvRandomAccessDecoder::DecodeNextPacket()
+{
+    if (m_bFlushed)
+    {
+        return false;
+    }
+
+    std::shared_ptr<PacketData> packet = m_pSeekPacket ? std::move(m_pSeekPacket) : m_demuxer->Demux();
+    m_pSeekPacket.reset();
+    std::vector<DecodedFrame> frames;
+    if (packet->bsl)
+    {
+        frames = m_decoder->DecodeFrames(*packet);
+        m_nNextPacket++;
+        m_nDecodedPacket++;
+    }
+    else if (m_demuxer->isEOF())
+    {
+        // Drain the pictures the decoder still holds for reordering
+        m_bFlushed = true;
+        frames = m_decoder->DecodeFrames(PacketData());
+    }
+
+    for (auto& frame : frames)
+    {
+        m_vPending.push_back(std::move(frame));
+    }
+    return true;
+}
+
+DecodedFrame PyNvRandomAccessDecoder::GetFrame(const Request& request)
+{
+    // Decoding forward reaches the frame without a seek when its key frame has been demuxed since the last seek
+    // and no later frame has been discarded yet
+    bool bAhead = m_bPositioned && request.key >= m_nSeekKey && request.key <= m_nNextPacket
+        && request.pts > m_nConsumedPts;
+    if (bAhead)
+    {
+        m_nContinue++;
+    }
+    else
+    {
+        SeekToKey(request.key);
+    }
+
+    while (true)
+    {
+        while (!m_vPending.empty())
+        {
+            const DecodedFrame& frame = m_vPending.front();
+            if (frame.timestamp == request.pts)
+            {
+                // kept for the following requests of the same frame
+                return frame;
+            }
+            if (frame.timestamp > request.pts)
+            {
+                throw std::runtime_error("Frame at pts " + std::to_string(request.pts)
+                    + " was dropped, skipped or could not be decoded");
+            }
+            m_nConsumedPts = frame.timestamp;
+            m_vPending.pop_front();
+        }
+        if (!DecodeNextPacket())
+        {
+            throw std::runtime_error("The requested frame was not output by the decoder");
+        }
+    }
+}
+
+std::vector<DecodedFrame> PyNvRandomAccessDecoder::GetFrames(std::vector<Request> requests)
+{
+    // GOPs in decode order and the frames of a GOP in display order, so that no GOP is decoded twice
+    std::sort(requests.begin(), requests.end(), [](const Request& a, const Request& b) {
+        return a.key != b.key ? a.key < b.key : a.pts < b.pts;
+    });
+
+    std::vector<DecodedFrame> frames(requests.size());
+    for (const Request& request : requests)
+    {
+        frames[request.slot] = GetFrame(request);
+    }
+    return frames;
+}
+
+std::vector<DecodedFrame> PyNvRandomAccessDecoder::GetFramesByIndex(const std::vector<size_t>& indices)
+{
+    const PacketIndex& index = m_demuxer->GetPacketIndex();
+    std::vector<Request> requests;
+    requests.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        if (indices[i] >= index.Size())
+        {
+            throw std::out_of_range("Frame index " + std::to_string(indices[i]) + " is out of range, the file has "
+                + std::to_string(index.Size()) + " frames");
+        }
+        requests.push_back(MakeRequest(index.GetDisplayEntry(indices[i]), i));
+    }
+
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> lock(m_mtxRequest);
+    return GetFrames(std::move(requests));
+}
+
+std::vector<DecodedFrame> PyNvRandomAccessDecoder::GetFramesAt(const std::vector<double>& times)
+{
+    const PacketIndex& index = m_demuxer->GetPacketIndex();
+    std::vector<Request> requests;
+    requests.reserve(times.size());
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        size_t nTarget = 0, nKey = 0;
+        if (!index.Find(m_demuxer->TsFromTime(times[i]), &nTarget, &nKey))
+        {
+            throw std::out_of_range("Time " + std::to_string(times[i]) + " is past the last frame");
+        }
+        requests.push_back(MakeRequest(nTarget, i));
+    }
+
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> lock(m_mtxRequest);
+    return GetFrames(std::move(requests));
+}
+
+std::map<std::string, int> PyNvRandomAccessDecoder::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_mtxRequest);
+    std::map<std::string, int> stats;
+    stats["seeks"] = m_nSeek;
+    stats["forward_requests"] = m_nContinue;
+    stats["decoded_packets"] = m_nDecodedPacket;
+    return stats;
+}
+
+void Init_PyNvRandomAccessDecoder(py::module& m)
+{
+    py::class_<PyNvRandomAccessDecoder, shared_ptr<PyNvRandomAccessDecoder>>(m, "PyNvRandomAccessDecoder", py::module_local())
+        .def(py::init<const std::string&, int, bool, const std::string&>(),
+            py::arg("filename"),
+            py::arg("gpuid") = 0,
+            py::arg("usedevicememory") = 1,
+            py::arg("indexpath") = "",
+            R"pbdoc(
+                Constructor method. Opens a file for frame accurate random access.
+                The packet index of the file is loaded from indexpath, or built and saved there first
+                (see PyNvDemuxer.BuildIndex).
+                :param filename: path of the media file
+                :param gpuid: GPU Id of the decoder
+                :param usedevicememory: decoded frames are in device memory if true else in host memory
+                :param indexpath: path of the packet index, empty for the default sidecar path next to the file
+            )pbdoc")
+        .def("GetFrames",
+            &PyNvRandomAccessDecoder::GetFramesByIndex,
+            py::arg("indices"),
+            R"pbdoc(
+                Decodes the frames with the given indices in display order. Requests are served by GOP in decode order,
+                decoding forward within a GOP instead of seeking, so each GOP is decoded at most once.
+                Raises RuntimeError when a requested frame is not output, e.g. because it was dropped or skipped.
+                :param indices: frame indices, in any order and possibly repeated
+                :return: list of DecodedFrame in the order of indices
+            )pbdoc")
+        .def("GetFrame",
+            [](shared_ptr<PyNvRandomAccessDecoder>& self, size_t index) {
+                return self->GetFramesByIndex({ index }).front();
+            },
+            py::arg("index"),
+            R"pbdoc(
+                Decodes the frame with the given index in display order, continuing from the previous request
+                when the frame is ahead of it in the same GOP
+                :param index: frame index
+                :return: DecodedFrame
+            )pbdoc")
+        .def("GetFramesAt",
+            &PyNvRandomAccessDecoder::GetFramesAt,
+            py::arg("times"),
+            R"pbdoc(
+                Decodes the first frames displayed at or after the given times, batched like GetFrames
+                :param times: times in seconds
+                :return: list of DecodedFrame in the order of times
+            )pbdoc")
+        .def("GetFrameAt",
+            [](shared_ptr<PyNvRandomAccessDecoder>& self, double time) {
+                return self->GetFramesAt({ time }).front();
+            },
+            py::arg("time"),
+            R"pbdoc(
+                Decodes the first frame displayed at or after the given time
+                :param time: time in seconds
+                :return: DecodedFrame
+            )pbdoc")
+        .def("GetFrameCount",
+            &PyNvRandomAccessDecoder::GetFrameCount,
+            R"pbdoc(
+                Returns the number of frames of the file
+            )pbdoc")
+        .def("GetStats",
+            &PyNvRandomAccessDecoder::GetStats,
+            R"pbdoc(
+                Returns the random access counters
+                :return: dictionary with seeks, forward_requests (requests served by decoding forward) and decoded_packets
+            )pbdoc")
+        .def("GetDecoder",
+            &PyNvRandomAccessDecoder::GetDecoder,
+            R"pbdoc(
+                Returns the decoder, e.g. for its output format
+            )pbdoc");
+}
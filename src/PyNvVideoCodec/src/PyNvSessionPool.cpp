@@ -0,0 +1,266 @@
+/*
+ * This copyright notice applies to this file only
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PyNvSessionPool.hpp"
+
+using namespace std;
+
+namespace py = pybind11;
+
+PyNvSessionPool::PyNvSessionPool(const std::vector<int>& gpuids)
+{
+    ck(cuInit(0));
+    int nGpu = 0;
+    ck(cuDeviceGetCount(&nGpu));
+
+    std::vector<int> vGpu = gpuids;
+    if (vGpu.empty())
+    {
+        for (int i = 0; i < nGpu; i++)
+        {
+            vGpu.push_back(i);
+        }
+    }
+
+    for (int gpuid : vGpu)
+    {
+        if (gpuid < 0 || gpuid >= nGpu) {
+            std::ostringstream err;
+            err << "GPU ordinal out of range. Should be within [" << 0 << ", " << nGpu - 1 << "]" << std::endl;
+            throw std::invalid_argument(err.str());
+        }
+        for (const Device& device : m_vDevice)
+        {
+            if (device.gpuid == gpuid)
+            {
+                throw std::invalid_argument("GPU ordinal " + std::to_string(gpuid) + " is listed more than once");
+            }
+        }
+
+        CUdevice cuDevice = 0;
+        CUcontext cuContext = NULL;
+        ck(cuDeviceGet(&cuDevice, gpuid));
+        ck(cuDevicePrimaryCtxRetain(&cuContext, cuDevice));
+
+        Device device;
+        device.gpuid = gpuid;
+        device.context.reset(cuContext, [cuDevice](CUctx_st*) { cuDevicePrimaryCtxRelease(cuDevice); });
+        m_vDevice.push_back(std::move(device));
+    }
+
+    if (m_vDevice.empty())
+    {
+        throw std::runtime_error("No GPU available for the session pool");
+    }
+}
+
+std::pair<int, int> PyNvSessionPool::GetLoad(Device& device)
+{
+    int nSession = 0, nQueuedFrame = 0;
+
+    auto it = device.decoders.begin();
+    while (it != device.decoders.end())
+    {
+        if (auto decoder = it->lock())
+        {
+            nSession++;
+            nQueuedFrame += decoder->GetNumQueuedFrames();
+            ++it;
+        }
+        else
+        {
+            it = device.decoders.erase(it);
+        }
+    }
+
+    auto itEnc = device.encoders.begin();
+    while (itEnc != device.encoders.end())
+    {
+        if (auto encoder = itEnc->lock())
+        {
+            nSession++;
+            nQueuedFrame += encoder->GetNumQueuedFrames();
+            ++itEnc;
+        }
+        else
+        {
+            itEnc = device.encoders.erase(itEnc);
+        }
+    }
+
+    return { nSession, nQueuedFrame };
+}
+
+PyNvSessionPool::Device& PyNvSessionPool::SelectDevice()
+{
+    Device* pSelected = nullptr;
+    std::pair<int, int> selectedLoad;
+    for (Device& device : m_vDevice)
+    {
+        auto load = GetLoad(device);
+        // least sessions plus queued frames first, then least sessions
+        if (!pSelected
+            || load.first + load.second < selectedLoad.first + selectedLoad.second
+            || (load.first + load.second == selectedLoad.first + selectedLoad.second && load.first < selectedLoad.first))
+        {
+            pSelected = &device;
+            selectedLoad = load;
+        }
+    }
+    return *pSelected;
+}
+
+std::shared_ptr<PyNvDecoder> PyNvSessionPool::CreateDecoder(const std::function<std::shared_ptr<PyNvDecoder>(int gpuid, size_t context)>& factory)
+{
+    int gpuid = 0;
+    std::shared_ptr<CUctx_st> context;
+    {
+        std::lock_guard<std::mutex> lock(m_mtxDevice);
+        Device& device = SelectDevice();
+        gpuid = device.gpuid;
+        context = device.context;
+    }
+
+    // The factory may run Python code, which can switch threads, so it is called without the lock.
+    // Decoders created concurrently may therefore land on the same GPU.
+    std::shared_ptr<PyNvDecoder> decoder = factory(gpuid, reinterpret_cast<size_t>(context.get()));
+    // the session keeps the primary context of its GPU retained
+    decoder->SetContextOwner(context);
+
+    std::lock_guard<std::mutex> lock(m_mtxDevice);
+    for (Device& device : m_vDevice)
+    {
+        if (device.gpuid == gpuid)
+        {
+            device.decoders.push_back(decoder);
+        }
+    }
+    return decoder;
+}
+
+std::shared_ptr<PyNvEncoder> PyNvSessionPool::CreateEncoder(
+    int width,
+    int height,
+    std::string format,
+    bool useCPUInputBuffer,
+    std::map<std::string, std::string> config)
+{
+    int gpuid = 0;
+    std::shared_ptr<CUctx_st> context;
+    {
+        std::lock_guard<std::mutex> lock(m_mtxDevice);
+        Device& device = SelectDevice();
+        gpuid = device.gpuid;
+        context = device.context;
+    }
+
+    // Creating the NVENC session is slow, so it is done without the lock, as for decoders
+    std::shared_ptr<PyNvEncoder> encoder(
+        new PyNvEncoder(width, height, format, reinterpret_cast<size_t>(context.get()), 0, useCPUInputBuffer, config, gpuid),
+        [context](PyNvEncoder* p) { delete p; });
+
+    std::lock_guard<std::mutex> lock(m_mtxDevice);
+    for (Device& device : m_vDevice)
+    {
+        if (device.gpuid == gpuid)
+        {
+            device.encoders.push_back(encoder);
+        }
+    }
+    return encoder;
+}
+
+std::map<int, std::map<std::string, int>> PyNvSessionPool::GetDeviceLoad()
+{
+    std::lock_guard<std::mutex> lock(m_mtxDevice);
+    std::map<int, std::map<std::string, int>> deviceLoad;
+    for (Device& device : m_vDevice)
+    {
+        auto load = GetLoad(device);
+        deviceLoad[device.gpuid]["sessions"] = load.first;
+        deviceLoad[device.gpuid]["queued_frames"] = load.second;
+    }
+    return deviceLoad;
+}
+
+void Init_PyNvSessionPool(py::module& m)
+{
+    py::class_<PyNvSessionPool, shared_ptr<PyNvSessionPool>>(m, "PyNvSessionPool", py::module_local())
+        .def(py::init<const std::vector<int>&>(),
+            py::arg("gpuids") = std::vector<int>(),
+            R"pbdoc(
+                Constructor method. Creates a pool spreading decoder and encoder sessions across GPUs.
+                Sessions of a GPU share its primary context.
+                :param gpuids: GPU Ids used by the pool, all GPUs if empty
+            )pbdoc")
+        .def("CreateDecoder",
+            // every option of CreateDecoder is forwarded, so pooled decoders never miss one
+            [createDecoder = py::object(m.attr("CreateDecoder"))](std::shared_ptr<PyNvSessionPool>& self, cudaVideoCodec codec, py::kwargs kwargs)
+            {
+                if (kwargs.contains("gpuid") || kwargs.contains("cudacontext"))
+                {
+                    throw std::invalid_argument("The pool selects the GPU and CUDA context of its decoders");
+                }
+                // defaults of pooled decoders, which also select the CreateDecoder overload taking every option
+                if (!kwargs.contains("usedevicememory"))
+                {
+                    kwargs["usedevicememory"] = true;
+                }
+                if (!kwargs.contains("enableasyncallocations"))
+                {
+                    kwargs["enableasyncallocations"] = true;
+                }
+                return self->CreateDecoder([&](int gpuid, size_t context)
+                    {
+                        return createDecoder(py::arg("gpuid") = gpuid, py::arg("codec") = codec, py::arg("cudacontext") = context, **kwargs)
+                            .cast<std::shared_ptr<PyNvDecoder>>();
+                    });
+            },
+            py::arg("codec") = cudaVideoCodec::cudaVideoCodec_H264,
+            R"pbdoc(
+                Creates a decoder on the GPU with the fewest active sessions and queued frames.
+                Takes the keyword arguments of CreateDecoder except gpuid and cudacontext, which are set by the pool.
+                usedevicememory and enableasyncallocations default to 1
+            )pbdoc")
+        .def("CreateEncoder",
+            &PyNvSessionPool::CreateEncoder,
+            py::arg("width"),
+            py::arg("height"),
+            py::arg("format"),
+            py::arg("usecpuinputbuffer"),
+            py::arg("config") = std::map<std::string, std::string>(),
+            py::call_guard<py::gil_scoped_release>(),
+            R"pbdoc(
+                Creates an encoder on the GPU with the fewest active sessions and queued frames.
+                :param width, height, format, usecpuinputbuffer: same as for CreateEncoder
+                :param config: optional encoder parameters, as produced by format_optional_params
+            )pbdoc")
+        .def("GetDeviceLoad",
+            &PyNvSessionPool::GetDeviceLoad,
+            R"pbdoc(
+                Returns the number of active sessions and queued frames of every GPU in the pool
+                :return: dict of GPU Id to {"sessions", "queued_frames"}
+            )pbdoc");
+}
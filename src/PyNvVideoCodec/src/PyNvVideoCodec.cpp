@@ -63,6 +63,11 @@ static auto ThrowOnCudaError = [](CUresult res, int lineNum = -1) {
 void Init_PyNvDemuxer(py::module& m);
 void Init_PyNvEncoder(py::module& m);
 void Init_PyNvDecoder(py::module& m);
+void Init_PyNvSessionPool(py::module& m);
+void Init_PyNvAsyncDecoder(py::module& m);
+void Init_PyNvMemoryPool(py::module& m);
+void Init_PyNvDecoderPool(py::module& m);
+void Init_PyNvRandomAccessDecoder(py::module& m);
 
 PYBIND11_MODULE(_PyNvVideoCodec, m)
 {
@@ -70,6 +75,11 @@ PYBIND11_MODULE(_PyNvVideoCodec, m)
   Init_PyNvDemuxer(m);
   Init_PyNvEncoder(m);
   Init_PyNvDecoder(m);
+  Init_PyNvSessionPool(m);
+  Init_PyNvAsyncDecoder(m);
+  Init_PyNvMemoryPool(m);
+  Init_PyNvDecoderPool(m);
+  Init_PyNvRandomAccessDecoder(m);
 
   m.doc() = R"pbdoc(
         PyNvVideoCodec
@@ -80,6 +90,11 @@ PYBIND11_MODULE(_PyNvVideoCodec, m)
 
            PyNvEncoder
            PyNvDecoder
+           PyNvSessionPool
+           PyNvAsyncDecoder
+           PyNvMemoryPool
+           PyNvDecoderPool
+           PyNvRandomAccessDecoder
            
     )pbdoc";
 }
@@ -120,6 +120,8 @@ static float GetChromaHeightFactor(cudaVideoSurfaceFormat eSurfaceFormat)
         break;
     case cudaVideoSurfaceFormat_YUV444:
     case cudaVideoSurfaceFormat_YUV444_16Bit:
+    case cudaVideoSurfaceFormat_NV16:
+    case cudaVideoSurfaceFormat_P216:
         factor = 1.0;
         break;
     }
@@ -134,6 +136,8 @@ static int GetChromaPlaneCount(cudaVideoSurfaceFormat eSurfaceFormat)
     {
     case cudaVideoSurfaceFormat_NV12:
     case cudaVideoSurfaceFormat_P016:
+    case cudaVideoSurfaceFormat_NV16:
+    case cudaVideoSurfaceFormat_P216:
         numPlane = 1;
         break;
     case cudaVideoSurfaceFormat_YUV444:
@@ -146,6 +150,50 @@ static int GetChromaPlaneCount(cudaVideoSurfaceFormat eSurfaceFormat)
 }
 
 std::map<int, int64_t> NvDecoder::sessionOverHead = { {0,0}, {1,0} };
+std::map<std::tuple<CUdevice, cudaVideoCodec, cudaVideoChromaFormat, unsigned int>, CUVIDDECODECAPS> NvDecoder::decoderCapsCache;
+std::mutex NvDecoder::decoderCapsMutex;
+
+CUVIDDECODECAPS NvDecoder::GetDecoderCaps(CuvidFunctions& api, CUdevice cuDevice, CUcontext cuContext,
+    cudaVideoCodec eCodec, cudaVideoChromaFormat eChromaFormat, unsigned int nBitDepthMinus8)
+{
+    auto key = std::make_tuple(cuDevice, eCodec, eChromaFormat, nBitDepthMinus8);
+    {
+        std::lock_guard<std::mutex> lock(decoderCapsMutex);
+        auto it = decoderCapsCache.find(key);
+        if (it != decoderCapsCache.end())
+        {
+            return it->second;
+        }
+    }
+
+    CUVIDDECODECAPS decodecaps;
+    memset(&decodecaps, 0, sizeof(decodecaps));
+    decodecaps.eCodecType = eCodec;
+    decodecaps.eChromaFormat = eChromaFormat;
+    decodecaps.nBitDepthMinus8 = nBitDepthMinus8;
+
+    bool bReleasePrimaryContext = !cuContext;
+    if (bReleasePrimaryContext)
+    {
+        CUDA_DRVAPI_CALL(cuDevicePrimaryCtxRetain(&cuContext, cuDevice));
+    }
+    CUDA_DRVAPI_CALL(cuCtxPushCurrent(cuContext));
+    CUresult result = api.cuvidGetDecoderCaps(&decodecaps);
+    CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
+    if (bReleasePrimaryContext)
+    {
+        CUDA_DRVAPI_CALL(cuDevicePrimaryCtxRelease(cuDevice));
+    }
+    if (result != CUDA_SUCCESS)
+    {
+        NVDEC_THROW_ERROR("cuvidGetDecoderCaps failed", result);
+    }
+
+    // concurrent queries of the same key store the same result
+    std::lock_guard<std::mutex> lock(decoderCapsMutex);
+    decoderCapsCache[key] = decodecaps;
+    return decodecaps;
+}
 
 
 /**
@@ -200,18 +248,10 @@ int NvDecoder::HandleVideoSequence(CUVIDEOFORMAT *pVideoFormat)
     ;
     m_videoInfo << std::endl;
 
-    int nDecodeSurface = pVideoFormat->min_num_decode_surfaces;
-
-    CUVIDDECODECAPS decodecaps;
-    memset(&decodecaps, 0, sizeof(decodecaps));
-
-    decodecaps.eCodecType = pVideoFormat->codec;
-    decodecaps.eChromaFormat = pVideoFormat->chroma_format;
-    decodecaps.nBitDepthMinus8 = pVideoFormat->bit_depth_luma_minus8;
+    int nDecodeSurface = (std::min)(pVideoFormat->min_num_decode_surfaces + (int)m_nExtraDecodeSurfaces, MAX_FRM_CNT);
 
-    CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
-    NVDEC_API_CALL(m_api.cuvidGetDecoderCaps(&decodecaps));
-    CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
+    CUVIDDECODECAPS decodecaps = GetDecoderCaps(m_api, m_cuDevice, m_cuContext,
+        pVideoFormat->codec, pVideoFormat->chroma_format, pVideoFormat->bit_depth_luma_minus8);
 
     if(!decodecaps.bIsSupported){
         NVDEC_THROW_ERROR("Codec not supported on this GPU", CUDA_ERROR_NOT_SUPPORTED);
@@ -245,6 +285,28 @@ int NvDecoder::HandleVideoSequence(CUVIDEOFORMAT *pVideoFormat)
         return nDecodeSurface;
     }
 
+    if (m_bResetPending && m_hDecoder) {
+        // A new bitstream reuses the session if it could have been decoded by it
+        m_bResetPending = false;
+        if (pVideoFormat->codec == m_eCodec && pVideoFormat->chroma_format == m_videoFormat.chroma_format
+            && pVideoFormat->bit_depth_luma_minus8 == m_videoFormat.bit_depth_luma_minus8
+            && pVideoFormat->bit_depth_chroma_minus8 == m_videoFormat.bit_depth_chroma_minus8
+            && pVideoFormat->coded_width <= m_nMaxWidth && pVideoFormat->coded_height <= m_nMaxHeight
+            && nDecodeSurface <= m_nCreatedDecodeSurfaces)
+        {
+            // output the display area of the new bitstream instead of scaling to the previous one
+            m_bReconfigExternal = false;
+            m_bReconfigExtPPChange = true;
+            m_nSessionReuse++;
+        }
+        else
+        {
+            DestroyDecoderSession();
+            m_nSessionRecreate++;
+        }
+    }
+    m_bResetPending = false;
+
     if (m_nWidth && m_nLumaHeight && m_nChromaHeight) {
 
         // cuvidCreateDecoder() has been called before, and now there's possible config change
@@ -263,12 +325,16 @@ int NvDecoder::HandleVideoSequence(CUVIDEOFORMAT *pVideoFormat)
     else if (m_eChromaFormat == cudaVideoChromaFormat_444)
         m_eOutputFormat = pVideoFormat->bit_depth_luma_minus8 ? cudaVideoSurfaceFormat_YUV444_16Bit : cudaVideoSurfaceFormat_YUV444;
     else if (m_eChromaFormat == cudaVideoChromaFormat_422)
-        m_eOutputFormat = cudaVideoSurfaceFormat_NV12;  // no 4:2:2 output format supported yet so make 420 default
+        m_eOutputFormat = pVideoFormat->bit_depth_luma_minus8 ? cudaVideoSurfaceFormat_P216 : cudaVideoSurfaceFormat_NV16;
 
     // Check if output format supported. If not, check falback options
     if (!(decodecaps.nOutputFormatMask & (1 << m_eOutputFormat)))
     {
-        if (decodecaps.nOutputFormatMask & (1 << cudaVideoSurfaceFormat_NV12))
+        // 4:2:2 output needs a GPU and driver that report it, older ones only output 4:2:0 for 4:2:2 streams
+        if (m_eChromaFormat == cudaVideoChromaFormat_422 && (decodecaps.nOutputFormatMask & (1 << cudaVideoSurfaceFormat_P016))
+            && pVideoFormat->bit_depth_luma_minus8)
+            m_eOutputFormat = cudaVideoSurfaceFormat_P016;
+        else if (decodecaps.nOutputFormatMask & (1 << cudaVideoSurfaceFormat_NV12))
             m_eOutputFormat = cudaVideoSurfaceFormat_NV12;
         else if (decodecaps.nOutputFormatMask & (1 << cudaVideoSurfaceFormat_P016))
             m_eOutputFormat = cudaVideoSurfaceFormat_P016;
@@ -281,6 +347,16 @@ int NvDecoder::HandleVideoSequence(CUVIDEOFORMAT *pVideoFormat)
     }
     m_videoFormat = *pVideoFormat;
 
+    if (m_bZeroCopyOutput && m_nNumOutputSurfaces + nDecodeSurface > MAX_OUTPUT_SURFACE_CNT)
+    {
+        std::ostringstream errorString;
+        errorString << "Zero-copy output needs " << m_nNumOutputSurfaces << " output surfaces plus one per decode surface ("
+                    << pVideoFormat->min_num_decode_surfaces << " required by the stream + " << m_nExtraDecodeSurfaces
+                    << " extra), more than the " << MAX_OUTPUT_SURFACE_CNT
+                    << " a decoder session supports; reduce numoutputsurfaces or extradecodesurfaces";
+        NVDEC_THROW_ERROR(errorString.str(), CUDA_ERROR_NOT_SUPPORTED);
+    }
+
     CUVIDDECODECREATEINFO videoDecodeCreateInfo = { 0 };
     videoDecodeCreateInfo.CodecType = pVideoFormat->codec;
     videoDecodeCreateInfo.ChromaFormat = pVideoFormat->chroma_format;
@@ -290,10 +366,12 @@ int NvDecoder::HandleVideoSequence(CUVIDEOFORMAT *pVideoFormat)
         videoDecodeCreateInfo.DeinterlaceMode = cudaVideoDeinterlaceMode_Weave;
     else
         videoDecodeCreateInfo.DeinterlaceMode = cudaVideoDeinterlaceMode_Adaptive;
-    videoDecodeCreateInfo.ulNumOutputSurfaces = 2;
+    // Pictures output by a Decode() call are mapped before the application fetches them, at most one per decode surface
+    videoDecodeCreateInfo.ulNumOutputSurfaces = m_nCreatedOutputSurfaces =
+        m_bZeroCopyOutput ? m_nNumOutputSurfaces + nDecodeSurface : m_nNumOutputSurfaces;
     // With PreferCUVID, JPEG is still decoded by CUDA while video is decoded by NVDEC hardware
     videoDecodeCreateInfo.ulCreationFlags = cudaVideoCreate_PreferCUVID;
-    videoDecodeCreateInfo.ulNumDecodeSurfaces = nDecodeSurface;
+    videoDecodeCreateInfo.ulNumDecodeSurfaces = m_nNumDecodeSurfaces = m_nCreatedDecodeSurfaces = nDecodeSurface;
     videoDecodeCreateInfo.vidLock = m_ctxLock;
     videoDecodeCreateInfo.ulWidth = pVideoFormat->coded_width;
     videoDecodeCreateInfo.ulHeight = pVideoFormat->coded_height;
@@ -321,15 +399,7 @@ int NvDecoder::HandleVideoSequence(CUVIDEOFORMAT *pVideoFormat)
         videoDecodeCreateInfo.ulTargetWidth = pVideoFormat->coded_width;
         videoDecodeCreateInfo.ulTargetHeight = pVideoFormat->coded_height;
     } else {
-        if (m_resizeDim.w && m_resizeDim.h) {
-            videoDecodeCreateInfo.display_area.left = pVideoFormat->display_area.left;
-            videoDecodeCreateInfo.display_area.top = pVideoFormat->display_area.top;
-            videoDecodeCreateInfo.display_area.right = pVideoFormat->display_area.right;
-            videoDecodeCreateInfo.display_area.bottom = pVideoFormat->display_area.bottom;
-            m_nWidth = m_resizeDim.w;
-            m_nLumaHeight = m_resizeDim.h;
-        }
-
+        // crop selects the source area, resize scales it to the output size
         if (m_cropRect.r && m_cropRect.b) {
             videoDecodeCreateInfo.display_area.left = m_cropRect.l;
             videoDecodeCreateInfo.display_area.top = m_cropRect.t;
@@ -337,6 +407,16 @@ int NvDecoder::HandleVideoSequence(CUVIDEOFORMAT *pVideoFormat)
             videoDecodeCreateInfo.display_area.bottom = m_cropRect.b;
             m_nWidth = m_cropRect.r - m_cropRect.l;
             m_nLumaHeight = m_cropRect.b - m_cropRect.t;
+        } else {
+            videoDecodeCreateInfo.display_area.left = pVideoFormat->display_area.left;
+            videoDecodeCreateInfo.display_area.top = pVideoFormat->display_area.top;
+            videoDecodeCreateInfo.display_area.right = pVideoFormat->display_area.right;
+            videoDecodeCreateInfo.display_area.bottom = pVideoFormat->display_area.bottom;
+        }
+
+        if (m_resizeDim.w && m_resizeDim.h) {
+            m_nWidth = m_resizeDim.w;
+            m_nLumaHeight = m_resizeDim.h;
         }
         videoDecodeCreateInfo.ulTargetWidth = m_nWidth;
         videoDecodeCreateInfo.ulTargetHeight = m_nLumaHeight;
@@ -363,17 +443,11 @@ int NvDecoder::HandleVideoSequence(CUVIDEOFORMAT *pVideoFormat)
     CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
     NVDEC_API_CALL(m_api.cuvidCreateDecoder(&m_hDecoder, &videoDecodeCreateInfo));
     CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
-    uint8_t* pFrame[8] = { NULL };
-    if (m_bUseDeviceFrame)
-        {
-            if (m_bEnableAsyncAllocations)
-            {
-                for (size_t i = 0; i < 8; i++)
-                {
-                    CUDA_DRVAPI_CALL(cuMemAllocAsync((CUdeviceptr*)&pFrame[i], GetFrameSize(), m_cuvidStream));
-                }
-            }
-        }
+    {
+        std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+        ResizeFrameStock();
+    }
+    PreallocateFrames();
     STOP_TIMER("Session Initialization Time: ");
     NvDecoder::addDecoderSessionOverHead(getDecoderSessionID(), elapsedTime);
     return nDecodeSurface;
@@ -382,6 +456,7 @@ int NvDecoder::HandleVideoSequence(CUVIDEOFORMAT *pVideoFormat)
 int NvDecoder::ReconfigureDecoder(CUVIDEOFORMAT *pVideoFormat)
 {
     NVTX_SCOPED_RANGE("recon")
+    unsigned int nPrevWidth = m_nWidth, nPrevLumaHeight = m_nLumaHeight;
     if (pVideoFormat->bit_depth_luma_minus8 != m_videoFormat.bit_depth_luma_minus8 || pVideoFormat->bit_depth_chroma_minus8 != m_videoFormat.bit_depth_chroma_minus8){
 
         NVDEC_THROW_ERROR("Reconfigure Not supported for bit depth change", CUDA_ERROR_NOT_SUPPORTED);
@@ -396,7 +471,7 @@ int NvDecoder::ReconfigureDecoder(CUVIDEOFORMAT *pVideoFormat)
     bool bDisplayRectChange = !(pVideoFormat->display_area.bottom == m_videoFormat.display_area.bottom && pVideoFormat->display_area.top == m_videoFormat.display_area.top \
         && pVideoFormat->display_area.left == m_videoFormat.display_area.left && pVideoFormat->display_area.right == m_videoFormat.display_area.right);
 
-    int nDecodeSurface = pVideoFormat->min_num_decode_surfaces;
+    int nDecodeSurface = (std::min)(pVideoFormat->min_num_decode_surfaces + (int)m_nExtraDecodeSurfaces, MAX_FRM_CNT);
 
     if ((pVideoFormat->coded_width > m_nMaxWidth) || (pVideoFormat->coded_height > m_nMaxHeight)) {
         // For VP9, let driver  handle the change if new width/height > maxwidth/maxheight
@@ -416,6 +491,12 @@ int NvDecoder::ReconfigureDecoder(CUVIDEOFORMAT *pVideoFormat)
             m_nLumaHeight = pVideoFormat->display_area.bottom - pVideoFormat->display_area.top;
             m_nChromaHeight = (int)ceil(m_nLumaHeight * GetChromaHeightFactor(m_eOutputFormat));
             m_nNumChromaPlanes = GetChromaPlaneCount(m_eOutputFormat);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+                ResizeFrameStock();
+            }
+            PreallocateFrames();
         }
 
         // no need for reconfigureDecoder(). Just return
@@ -449,15 +530,6 @@ int NvDecoder::ReconfigureDecoder(CUVIDEOFORMAT *pVideoFormat)
             reconfigParams.ulTargetHeight = pVideoFormat->coded_height;
         }
         else {
-            if (m_resizeDim.w && m_resizeDim.h) {
-                reconfigParams.display_area.left = pVideoFormat->display_area.left;
-                reconfigParams.display_area.top = pVideoFormat->display_area.top;
-                reconfigParams.display_area.right = pVideoFormat->display_area.right;
-                reconfigParams.display_area.bottom = pVideoFormat->display_area.bottom;
-                m_nWidth = m_resizeDim.w;
-                m_nLumaHeight = m_resizeDim.h;
-            }
-
             if (m_cropRect.r && m_cropRect.b) {
                 reconfigParams.display_area.left = m_cropRect.l;
                 reconfigParams.display_area.top = m_cropRect.t;
@@ -466,6 +538,17 @@ int NvDecoder::ReconfigureDecoder(CUVIDEOFORMAT *pVideoFormat)
                 m_nWidth = m_cropRect.r - m_cropRect.l;
                 m_nLumaHeight = m_cropRect.b - m_cropRect.t;
             }
+            else {
+                reconfigParams.display_area.left = pVideoFormat->display_area.left;
+                reconfigParams.display_area.top = pVideoFormat->display_area.top;
+                reconfigParams.display_area.right = pVideoFormat->display_area.right;
+                reconfigParams.display_area.bottom = pVideoFormat->display_area.bottom;
+            }
+
+            if (m_resizeDim.w && m_resizeDim.h) {
+                m_nWidth = m_resizeDim.w;
+                m_nLumaHeight = m_resizeDim.h;
+            }
             reconfigParams.ulTargetWidth = m_nWidth;
             reconfigParams.ulTargetHeight = m_nLumaHeight;
         }
@@ -480,37 +563,23 @@ int NvDecoder::ReconfigureDecoder(CUVIDEOFORMAT *pVideoFormat)
         m_displayRect.r = reconfigParams.display_area.right;
     }
 
-    reconfigParams.ulNumDecodeSurfaces = nDecodeSurface;
+    reconfigParams.ulNumDecodeSurfaces = m_nNumDecodeSurfaces = nDecodeSurface;
 
     START_TIMER
     CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
     NVDEC_API_CALL(m_api.cuvidReconfigureDecoder(m_hDecoder, &reconfigParams));
-    //deallocate earlier buffers
-    for (uint8_t* pFrame : m_vpFrame)
-    {
-        if (m_bUseDeviceFrame)
-        {
-            if (m_bEnableAsyncAllocations)
-            {
-                CUDA_DRVAPI_CALL(cuMemFreeAsync((*(CUdeviceptr*)&pFrame), NULL));//sync on NULL stream to ensure that all work is completed before dtor
-            }
-        }
-    }
-    //recreate new buffers
-    uint8_t* pFrame[8] = { NULL };
-    if (m_bUseDeviceFrame)
-        {
-            if (m_bEnableAsyncAllocations)
-            {
-                for (size_t i = 0; i < 8; i++)
-                {
-                    CUDA_DRVAPI_CALL(cuMemAllocAsync((CUdeviceptr*)&pFrame[i], GetFrameSize(), m_cuvidStream));
-                }
-            }
-        }
+    m_nReconfigure++;
     CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
     STOP_TIMER("Session Reconfigure Time: ");
 
+    if (m_nWidth != nPrevWidth || m_nLumaHeight != nPrevLumaHeight)
+    {
+        // frames of the previous output size are only reused if the new output fits in them
+        std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+        ResizeFrameStock();
+    }
+    PreallocateFrames();
+
     return nDecodeSurface;
 }
 
@@ -531,6 +600,8 @@ std::vector<std::tuple<CUdeviceptr, int64_t>> NvDecoder::Decode(uint8_t* bsl_dat
         case cudaVideoSurfaceFormat_YUV444:
         case cudaVideoSurfaceFormat_YUV444_16Bit:
         case cudaVideoSurfaceFormat_NV12:
+        case cudaVideoSurfaceFormat_NV16:
+        case cudaVideoSurfaceFormat_P216:
         {
             break;
 
@@ -567,25 +638,157 @@ int NvDecoder::setReconfigParams(const Rect *pCropRect, const Dim *pResizeDim)
         }
     }
 
-    // Clear existing output buffers of different size
+    // Output buffers of a different size are released when the decoder is reconfigured at the next sequence header
+    return 1;
+}
+
+uint8_t* NvDecoder::AllocFrame()
+{
+    // The first frame of an output size sets the size of all the frames in stock
+    if (!m_nFrameRowBytes)
+    {
+        m_nFrameRowBytes = GetWidth() * m_nBPP;
+        m_nFrameRows = m_nLumaHeight + (m_nChromaHeight * m_nNumChromaPlanes);
+    }
+    size_t nFrameSize = m_nFrameRowBytes * m_nFrameRows;
+
     uint8_t *pFrame = NULL;
-    while (!m_vpFrame.empty())
+    if (m_bUseDeviceFrame)
     {
-        pFrame = m_vpFrame.back();
-        m_vpFrame.pop_back();
-        if (m_bUseDeviceFrame)
+        CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
+        if (m_bDeviceFramePitched)
         {
-            CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
-            CUDA_DRVAPI_CALL(cuMemFree((CUdeviceptr)pFrame));
-            CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
+            CUDA_DRVAPI_CALL(cuMemAllocPitch((CUdeviceptr *)&pFrame, &m_nDeviceFramePitch, m_nFrameRowBytes, m_nFrameRows, 16));
+        }
+        else if (m_bEnableAsyncAllocations && m_hMemPool)
+        {
+            CUDA_DRVAPI_CALL(cuMemAllocFromPoolAsync((CUdeviceptr*)&pFrame, nFrameSize, m_hMemPool, m_cuvidStream));
+        }
+        else if (m_bEnableAsyncAllocations)
+        {
+            CUDA_DRVAPI_CALL(cuMemAllocAsync((CUdeviceptr*)&pFrame, nFrameSize, m_cuvidStream));
+        }
+        else
+        {
+            CUDA_DRVAPI_CALL(cuMemAlloc((CUdeviceptr *)&pFrame, nFrameSize));
+        }
+        CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
+    }
+    else if (m_bPinnedHostFrame)
+    {
+        CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
+        CUDA_DRVAPI_CALL(cuMemHostAlloc((void**)&pFrame, nFrameSize, 0));
+        CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
+    }
+    else
+    {
+        pFrame = new uint8_t[nFrameSize];
+    }
+    m_nFrameAllocCount++;
+    return pFrame;
+}
+
+void NvDecoder::FreeFrame(uint8_t *pFrame)
+{
+    if (m_bUseDeviceFrame)
+    {
+        CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
+        if (m_bEnableAsyncAllocations && !m_bDeviceFramePitched)
+        {
+            // ordered after the copies still pending on the decoder stream
+            CUDA_DRVAPI_CALL(cuMemFreeAsync((CUdeviceptr)pFrame, m_cuvidStream));
         }
         else
         {
-            delete pFrame;
+            CUDA_DRVAPI_CALL(cuMemFree((CUdeviceptr)pFrame));
         }
+        CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
+    }
+    else if (m_bPinnedHostFrame)
+    {
+        CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
+        CUDA_DRVAPI_CALL(cuMemFreeHost(pFrame));
+        CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
+    }
+    else
+    {
+        delete[] pFrame;
     }
+    m_nFrameFreeCount++;
+}
 
-    return 1;
+void NvDecoder::SetPinnedHostFrames(bool bPinned)
+{
+    std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+    if (m_nFrameAlloc)
+    {
+        NVDEC_THROW_ERROR("Host frame memory can't be changed once frames are allocated", CUDA_ERROR_NOT_SUPPORTED);
+    }
+    m_bPinnedHostFrame = bPinned;
+}
+
+void NvDecoder::WaitForFrameCopy(CUevent hCopyEvent)
+{
+    if (hCopyEvent)
+    {
+        NVTX_SCOPED_RANGE("decodehelper::waitforcopy")
+        CUDA_DRVAPI_CALL(cuEventSynchronize(hCopyEvent));
+    }
+}
+
+void NvDecoder::ReleaseFrameStock()
+{
+    // Frames decoded by the current call or returned by GetFrame() are still referenced and only marked stale,
+    // like the frames locked by the application
+    size_t nReferenced = m_nDecodedFrameReturned + m_nDecodedFrame;
+    while (m_vFrame.size() > nReferenced)
+    {
+        FreeFrame(m_vFrame.back().pFrame);
+        m_vFrame.pop_back();
+        m_nFrameAlloc--;
+    }
+    for (size_t i = 0; i < m_vFrame.size(); i++)
+    {
+        m_setStaleFrame.insert(m_vFrame[i].pFrame);
+    }
+    m_setStaleFrame.insert(m_setLockedFrame.begin(), m_setLockedFrame.end());
+}
+
+void NvDecoder::ResizeFrameStock()
+{
+    size_t nRowBytes = GetWidth() * m_nBPP;
+    unsigned int nRows = m_nLumaHeight + (m_nChromaHeight * m_nNumChromaPlanes);
+    // Pitched frames keep their row layout, linear frames are repacked at the new width
+    bool bFits = m_bDeviceFramePitched ? (nRowBytes <= m_nFrameRowBytes && nRows <= m_nFrameRows)
+        : (nRowBytes * nRows <= m_nFrameRowBytes * m_nFrameRows);
+    if (bFits)
+    {
+        return;
+    }
+    ReleaseFrameStock();
+    m_nFrameRowBytes = 0;
+    m_nFrameRows = 0;
+}
+
+void NvDecoder::PreallocateFrames()
+{
+    std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+    if (!m_nPreallocFrame || m_bZeroCopyOutput)
+    {
+        return;
+    }
+    int nFrames = m_nPreallocFrame < 0 ? m_nNumDecodeSurfaces : m_nPreallocFrame;
+    if (m_nMaxFrameAlloc)
+    {
+        nFrames = (std::min)(nFrames, (int)m_nMaxFrameAlloc);
+    }
+    // stale frames in stock are replaced when they are next decoded into, and count as usable here
+    while ((int)m_vFrame.size() < nFrames && (!m_nMaxFrameAlloc || (unsigned)m_nFrameAlloc < m_nMaxFrameAlloc))
+    {
+        m_vFrame.push_back({ AllocFrame(), 0, cuvidDecodeStatus_Invalid });
+        m_nFrameAlloc++;
+        m_nPreallocFrameCount++;
+    }
 }
 
 /* Return value from HandlePictureDecode() are interpreted as:
@@ -598,6 +801,16 @@ int NvDecoder::HandlePictureDecode(CUVIDPICPARAMS *pPicParams) {
         NVDEC_THROW_ERROR("Decoder not initialized.", CUDA_ERROR_NOT_INITIALIZED);
         return false;
     }
+    bool& bSkipped = m_abSkippedPicture[pPicParams->CurrPicIdx];
+    if (!pPicParams->second_field)
+    {
+        bSkipped = (m_bSkipNonReference && !pPicParams->ref_pic_flag) || (m_bSkipNonIntra && !pPicParams->intra_pic_flag);
+        m_nSkippedPicture += bSkipped;
+    }
+    if (bSkipped)
+    {
+        return 1;
+    }
     m_nPicNumInDecodeOrder[pPicParams->CurrPicIdx] = m_nDecodePicCnt++;
     CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
     NVDEC_API_CALL(m_api.cuvidDecodePicture(m_hDecoder, pPicParams));
@@ -608,6 +821,8 @@ int NvDecoder::HandlePictureDecode(CUVIDPICPARAMS *pPicParams) {
         dispInfo.picture_index = pPicParams->CurrPicIdx;
         dispInfo.progressive_frame = !pPicParams->field_pic_flag;
         dispInfo.top_field_first = pPicParams->bottom_field_flag ^ 1;
+        // Without reordering, the picture belongs to the packet being parsed
+        dispInfo.timestamp = m_nPacketTimestamp;
         HandlePictureDisplay(&dispInfo);
     }
     CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
@@ -626,44 +841,34 @@ int NvDecoder::HandlePictureDisplay(CUVIDPARSERDISPINFO *pDispInfo) {
     videoProcessingParameters.unpaired_field = pDispInfo->repeat_first_field < 0;
     videoProcessingParameters.output_stream = m_cuvidStream;
 
+    if (m_abSkippedPicture[pDispInfo->picture_index])
+    {
+        // The surface still holds an earlier picture
+        m_aSEIPicture[pDispInfo->picture_index].clear();
+        GetDecodeLatency(pDispInfo->timestamp);
+        return 1;
+    }
+
     if (m_bExtractSEIMessage)
     {
-        if (m_SEIMessagesDisplayOrder[pDispInfo->picture_index].pSEIData)
+        // The messages of the picture follow it in output order; the picture slot takes the previous buffers
+        size_t iOutput = m_nDecodedFrame;
+        if (m_vFrameSEI.size() <= iOutput)
         {
-            // Write SEI Message
-            uint8_t *seiBuffer = (uint8_t *)(m_SEIMessagesDisplayOrder[pDispInfo->picture_index].pSEIData);
-            uint32_t seiNumMessages = m_SEIMessagesDisplayOrder[pDispInfo->picture_index].sei_message_count;
-            CUSEIMESSAGE *seiMessagesInfo = m_SEIMessagesDisplayOrder[pDispInfo->picture_index].pSEIMessage;
-            if (m_fpSEI)
-            {
-                for (uint32_t i = 0; i < seiNumMessages; i++)
-                {
-                    if (m_eCodec == cudaVideoCodec_H264 || cudaVideoCodec_H264_SVC || cudaVideoCodec_H264_MVC || cudaVideoCodec_HEVC)
-                    {    
-                        switch (seiMessagesInfo[i].sei_message_type)
-                        {
-                            case SEI_TYPE_TIME_CODE:
-                            {
-                                HEVCSEITIMECODE *timecode = (HEVCSEITIMECODE *)seiBuffer;
-                                fwrite(timecode, sizeof(HEVCSEITIMECODE), 1, m_fpSEI);
-                            }
-                            break;
-                            case SEI_TYPE_USER_DATA_UNREGISTERED:
-                            {
-                                fwrite(seiBuffer, seiMessagesInfo[i].sei_message_size, 1, m_fpSEI);
-                            }
-                            break;
-                        }            
-                    }
-                    if (m_eCodec == cudaVideoCodec_AV1)
-                    {
-                        fwrite(seiBuffer, seiMessagesInfo[i].sei_message_size, 1, m_fpSEI);
-                    }    
-                    seiBuffer += seiMessagesInfo[i].sei_message_size;
-                }
-            }
-            free(m_SEIMessagesDisplayOrder[pDispInfo->picture_index].pSEIData);
-            free(m_SEIMessagesDisplayOrder[pDispInfo->picture_index].pSEIMessage);
+            m_vFrameSEI.resize(iOutput + 1);
+        }
+        std::swap(m_vFrameSEI[iOutput], m_aSEIPicture[pDispInfo->picture_index]);
+        m_aSEIPicture[pDispInfo->picture_index].clear();
+    }
+
+    if (m_bZeroCopyOutput)
+    {
+        // Every mapped frame holds one output surface. Decode() bounds the frames held by the application,
+        // so this only fails when more pictures are output than there are decode surfaces.
+        std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+        if (m_nMappedFrame >= (int)m_nCreatedOutputSurfaces)
+        {
+            NVDEC_THROW_ERROR("All decoder output surfaces are in use. Release decoded frames before decoding further", CUDA_ERROR_NOT_READY);
         }
     }
 
@@ -677,41 +882,73 @@ int NvDecoder::HandlePictureDisplay(CUVIDPARSERDISPINFO *pDispInfo) {
     CUVIDGETDECODESTATUS DecodeStatus;
     memset(&DecodeStatus, 0, sizeof(DecodeStatus));
     CUresult result = m_api.cuvidGetDecodeStatus(m_hDecoder, pDispInfo->picture_index, &DecodeStatus);
-    if (result == CUDA_SUCCESS && (DecodeStatus.decodeStatus == cuvidDecodeStatus_Error || DecodeStatus.decodeStatus == cuvidDecodeStatus_Error_Concealed))
+    cuvidDecodeStatus decodeStatus = result == CUDA_SUCCESS ? DecodeStatus.decodeStatus : cuvidDecodeStatus_Invalid;
+    bool bDropFrame = (decodeStatus == cuvidDecodeStatus_Error && m_bDropErrorFrame)
+        || (decodeStatus == cuvidDecodeStatus_Error_Concealed && m_bDropConcealedFrame);
     {
-        printf("Decode Error occurred for picture %d\n", m_nPicNumInDecodeOrder[pDispInfo->picture_index]);
+        std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+        m_nDecodeError += decodeStatus == cuvidDecodeStatus_Error;
+        m_nDecodeConcealed += decodeStatus == cuvidDecodeStatus_Error_Concealed;
+        m_nDroppedFrame += bDropFrame;
+    }
+    if (bDropFrame)
+    {
+        // The frame is dropped before it is copied or handed out
+        NVDEC_API_CALL(m_api.cuvidUnmapVideoFrame(m_hDecoder, dpSrcFrame));
+        CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
+        GetDecodeLatency(pDispInfo->timestamp);
+        return 1;
+    }
+
+    if (m_bZeroCopyOutput)
+    {
+        if (m_bEnableAsyncAllocations)
+        {
+            CUDA_DRVAPI_CALL(cuEventRecord(m_bCUEvent, m_cuvidStream));
+        }
+        else
+        {
+            CUDA_DRVAPI_CALL(cuStreamSynchronize(m_cuvidStream));
+        }
+        CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
+        int64_t latencyNs = GetDecodeLatency(pDispInfo->timestamp);
+
+        // Surface stays mapped until UnmapFrame()
+        std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+        m_vMappedFrame.push_back({ dpSrcFrame, nSrcPitch, pDispInfo->timestamp, latencyNs, decodeStatus });
+        m_nMappedFrame++;
+        m_nDecodedFrame++;
+        return 1;
     }
 
     uint8_t *pDecodedFrame = nullptr;
+    // only this thread takes frames out of the stock, so the index stays valid until the frame is fetched
+    int iDecodedFrame = 0;
     {
         std::lock_guard<std::mutex> lock(m_mtxVPFrame);
-        if ((unsigned)++m_nDecodedFrame > m_vpFrame.size())
+        if ((unsigned)++m_nDecodedFrame > m_vFrame.size())
         {
             // Not enough frames in stock
             m_nFrameAlloc++;
-            uint8_t *pFrame = NULL;
-            if (m_bUseDeviceFrame)
-            {
-                if (m_bDeviceFramePitched)
-                {
-                    CUDA_DRVAPI_CALL(cuMemAllocPitch((CUdeviceptr *)&pFrame, &m_nDeviceFramePitch, GetWidth() * m_nBPP, m_nLumaHeight + (m_nChromaHeight * m_nNumChromaPlanes), 16));
-                }
-                else if (m_bEnableAsyncAllocations)
-                {
-                    CUDA_DRVAPI_CALL(cuMemAllocAsync((CUdeviceptr*)&pFrame, GetFrameSize(), m_cuvidStream));
-                }
-                else
-                {
-                    CUDA_DRVAPI_CALL(cuMemAlloc((CUdeviceptr *)&pFrame, GetFrameSize()));
-                }
-            }
-            else
-            {
-                pFrame = new uint8_t[GetFrameSize()];
-            }
-            m_vpFrame.push_back(pFrame);
+            m_nFramePoolMiss++;
+            m_vFrame.push_back({ AllocFrame(), 0, cuvidDecodeStatus_Invalid });
+        }
+        else if (m_setStaleFrame.erase(m_vFrame[m_nDecodedFrame - 1].pFrame))
+        {
+            // Frame in stock has the previous output size
+            m_nFramePoolMiss++;
+            FreeFrame(m_vFrame[m_nDecodedFrame - 1].pFrame);
+            m_vFrame[m_nDecodedFrame - 1].pFrame = AllocFrame();
         }
-        pDecodedFrame = m_vpFrame[m_nDecodedFrame - 1];
+        else
+        {
+            m_nFramePoolHit++;
+        }
+        iDecodedFrame = m_nDecodedFrame - 1;
+        FrameDesc& frameDesc = m_vFrame[iDecodedFrame];
+        frameDesc.timestamp = pDispInfo->timestamp;
+        frameDesc.decodeStatus = decodeStatus;
+        pDecodedFrame = frameDesc.pFrame;
     }
     
     // Copy luma plane
@@ -741,6 +978,7 @@ int NvDecoder::HandlePictureDisplay(CUVIDPARSERDISPINFO *pDispInfo) {
         CUDA_DRVAPI_CALL(cuMemcpy2DAsync(&m, m_cuvidStream));
     }
 
+    CUevent hCopyEvent = NULL;
     if (m_bUseDeviceFrame)
     {
         if (m_bEnableAsyncAllocations)
@@ -752,66 +990,115 @@ int NvDecoder::HandlePictureDisplay(CUVIDPARSERDISPINFO *pDispInfo) {
             CUDA_DRVAPI_CALL(cuStreamSynchronize(m_cuvidStream));
         }
     }
+    else if (m_bPinnedHostFrame)
+    {
+        // The parser goes on with the next pictures while the copy is in flight
+        if ((size_t)iDecodedFrame >= m_vHostCopyEvent.size())
+        {
+            CUevent hEvent = NULL;
+            CUDA_DRVAPI_CALL(cuEventCreate(&hEvent, CU_EVENT_DISABLE_TIMING));
+            m_vHostCopyEvent.push_back(hEvent);
+        }
+        hCopyEvent = m_vHostCopyEvent[iDecodedFrame];
+        CUDA_DRVAPI_CALL(cuEventRecord(hCopyEvent, m_cuvidStream));
+    }
     
     CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
 
-    if ((int)m_vTimestamp.size() < m_nDecodedFrame) {
-        m_vTimestamp.resize(m_vpFrame.size());
-    }
-    m_vTimestamp[m_nDecodedFrame - 1] = pDispInfo->timestamp;
-
     NVDEC_API_CALL(m_api.cuvidUnmapVideoFrame(m_hDecoder, dpSrcFrame));
+
+    int64_t latencyNs = GetDecodeLatency(pDispInfo->timestamp);
+    {
+        std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+        m_vFrame[iDecodedFrame].latencyNs = latencyNs;
+        m_vFrame[iDecodedFrame].hCopyEvent = hCopyEvent;
+    }
     return 1;
 }
 
+int64_t NvDecoder::GetDecodeLatency(int64_t timestamp)
+{
+    auto now = std::chrono::steady_clock::now();
+    // Frames whose packet is unknown, e.g. with duplicated timestamps, are measured from the current Decode() call
+    auto tSubmit = m_tDecodeStart;
+    auto it = m_mapSubmitTime.find(timestamp);
+    if (it != m_mapSubmitTime.end())
+    {
+        tSubmit = it->second;
+        m_mapSubmitTime.erase(it);
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now - tSubmit).count();
+}
+
 int NvDecoder::GetSEIMessage(CUVIDSEIMESSAGEINFO *pSEIMessageInfo)
 {
-    uint32_t seiNumMessages = pSEIMessageInfo->sei_message_count;
-    CUSEIMESSAGE *seiMessagesInfo = pSEIMessageInfo->pSEIMessage;
-    size_t totalSEIBufferSize = 0;
     if ((pSEIMessageInfo->picIdx < 0) || (pSEIMessageInfo->picIdx >= MAX_FRM_CNT))
     {
         printf("Invalid picture index (%d)\n", pSEIMessageInfo->picIdx);
         return 0;
     }
-    for (uint32_t i = 0; i < seiNumMessages; i++)
+    SEIMessages& sei = m_aSEIPicture[pSEIMessageInfo->picIdx];
+    sei.clear();
+    const uint8_t *pPayload = (const uint8_t *)pSEIMessageInfo->pSEIData;
+    for (uint32_t i = 0; i < pSEIMessageInfo->sei_message_count; i++)
     {
-        totalSEIBufferSize += seiMessagesInfo[i].sei_message_size;
+        const CUSEIMESSAGE& message = pSEIMessageInfo->pSEIMessage[i];
+        if (m_seiTypeFilter.test(message.sei_message_type))
+        {
+            sei.messages.push_back(message);
+            sei.data.insert(sei.data.end(), pPayload, pPayload + message.sei_message_size);
+        }
+        pPayload += message.sei_message_size;
     }
-    if (!m_pCurrSEIMessage)
+    return 1;
+}
+
+void NvDecoder::SetSEIMessageFilter(const std::vector<int>& vTypes)
+{
+    m_seiTypeFilter.reset();
+    for (int type : vTypes)
     {
-        printf("Out of Memory, Allocation failed for m_pCurrSEIMessage\n");
-        return 0;
+        if (type < 0 || type >= (int)m_seiTypeFilter.size())
+        {
+            throw std::invalid_argument("SEI payload type out of range: " + std::to_string(type));
+        }
+        m_seiTypeFilter.set(type);
     }
-    m_pCurrSEIMessage->pSEIData = malloc(totalSEIBufferSize);
-    if (!m_pCurrSEIMessage->pSEIData)
+    if (vTypes.empty())
     {
-        printf("Out of Memory, Allocation failed for SEI Buffer\n");
-        return 0;
+        m_seiTypeFilter.set();
+    }
+}
+
+void NvDecoder::FetchFrameSEI(SEIMessages* pSEI)
+{
+    if (!m_bExtractSEIMessage)
+    {
+        return;
     }
-    memcpy(m_pCurrSEIMessage->pSEIData, pSEIMessageInfo->pSEIData, totalSEIBufferSize);
-    m_pCurrSEIMessage->pSEIMessage = (CUSEIMESSAGE *)malloc(sizeof(CUSEIMESSAGE) * seiNumMessages);
-    if (!m_pCurrSEIMessage->pSEIMessage)
+    if ((size_t)m_nFrameSEIFetched < m_vFrameSEI.size())
     {
-        free(m_pCurrSEIMessage->pSEIData);
-        m_pCurrSEIMessage->pSEIData = NULL;
-        return 0;
+        SEIMessages& sei = m_vFrameSEI[m_nFrameSEIFetched];
+        if (pSEI)
+        {
+            std::swap(*pSEI, sei);
+        }
+        sei.clear();
     }
-    memcpy(m_pCurrSEIMessage->pSEIMessage, pSEIMessageInfo->pSEIMessage, sizeof(CUSEIMESSAGE) * seiNumMessages);
-    m_pCurrSEIMessage->sei_message_count = pSEIMessageInfo->sei_message_count;
-    m_SEIMessagesDisplayOrder[pSEIMessageInfo->picIdx] = *m_pCurrSEIMessage;
-    return 1;
+    m_nFrameSEIFetched++;
 }
 
 NvDecoder::NvDecoder(CUstream cuStream,CUcontext cuContext, bool bUseDeviceFrame, cudaVideoCodec eCodec, 
     bool bLowLatency, bool bEnableAsyncAllocations, bool bDestroyContext,
     bool bDeviceFramePitched, const Rect *pCropRect, const Dim *pResizeDim, bool extract_user_SEI_Message,
-    int maxWidth, int maxHeight, unsigned int clkRate, bool force_zero_latency
+    int maxWidth, int maxHeight, unsigned int clkRate, bool force_zero_latency, bool bZeroCopyOutput, bool bWaitForFreeSurface,
+    unsigned int nNumOutputSurfaces, unsigned int nExtraDecodeSurfaces, int nMaxDisplayDelay
     ) :
     m_cuvidStream(cuStream),m_cuContext(cuContext), m_bUseDeviceFrame(bUseDeviceFrame), m_eCodec(eCodec), m_bEnableAsyncAllocations(bEnableAsyncAllocations),
     m_bDestroyContext(bDestroyContext),
     m_bDeviceFramePitched(bDeviceFramePitched), m_bExtractSEIMessage(extract_user_SEI_Message), m_nMaxWidth (maxWidth), m_nMaxHeight(maxHeight),
-    m_bForce_zero_latency(force_zero_latency)
+    m_bForce_zero_latency(force_zero_latency), m_bZeroCopyOutput(bZeroCopyOutput), m_bWaitForFreeSurface(bWaitForFreeSurface),
+    m_nNumOutputSurfaces(nNumOutputSurfaces), m_nExtraDecodeSurfaces(nExtraDecodeSurfaces), m_nClockRate(clkRate)
 {
     
     const char* err = loadCuvidSymbols(&this->m_api,
@@ -842,17 +1129,46 @@ NvDecoder::NvDecoder(CUstream cuStream,CUcontext cuContext, bool bUseDeviceFrame
             throw std::runtime_error(std::string(err) + "\n" + explanation);
         }
     }
+    if (m_bZeroCopyOutput && !m_bUseDeviceFrame)
+    {
+        throw std::invalid_argument("Zero-copy output requires decoded frames in device memory");
+    }
+    if (m_nNumOutputSurfaces == 0)
+    {
+        throw std::invalid_argument("At least one output surface is required");
+    }
+    if (m_nNumOutputSurfaces > MAX_OUTPUT_SURFACE_CNT)
+    {
+        throw std::invalid_argument("Output surfaces must not exceed " + std::to_string(MAX_OUTPUT_SURFACE_CNT));
+    }
+    if (m_nExtraDecodeSurfaces >= MAX_FRM_CNT)
+    {
+        throw std::invalid_argument("Extra decode surfaces must be less than " + std::to_string(MAX_FRM_CNT));
+    }
+    // -1 keeps the default display delay: none in low latency mode, one frame otherwise
+    m_nMaxDisplayDelay = nMaxDisplayDelay < 0 ? (bLowLatency ? 0 : 1) : (unsigned int)nMaxDisplayDelay;
+    if (m_cuContext)
+    {
+        CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
+        CUDA_DRVAPI_CALL(cuCtxGetDevice(&m_cuDevice));
+        CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
+    }
     if (m_bEnableAsyncAllocations)
     {
         std::cout << "enabling stream aware allocations!" << std::endl;
-        if (m_cuContext != 0 && m_cuvidStream != 0)
+        if (m_cuContext == 0)
         {
-            CUDA_DRVAPI_CALL(cuEventCreate(&m_bCUEvent, 0));
+            throw std::runtime_error("Please provide CUDA context that application has created");
         }
-        else
+        CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
+        if (m_cuvidStream == 0)
         {
-            throw std::runtime_error("Please provide CUDA context and CUDA stream that application has created");
+            // Stream-ordered frees on the NULL stream would serialize with all other work of the context
+            CUDA_DRVAPI_CALL(cuStreamCreate(&m_cuvidStream, CU_STREAM_NON_BLOCKING));
+            m_bDestroyStream = true;
         }
+        CUDA_DRVAPI_CALL(cuEventCreate(&m_bCUEvent, 0));
+        CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
     }
     
     
@@ -860,21 +1176,20 @@ NvDecoder::NvDecoder(CUstream cuStream,CUcontext cuContext, bool bUseDeviceFrame
     if (pResizeDim) m_resizeDim = *pResizeDim;
 
     NVDEC_API_CALL(m_api.cuvidCtxLockCreate(&m_ctxLock, cuContext));
-    createCudaStream(&cuStream, &cuContext, 0, 0);
 
     decoderSessionID = 0;
 
-    if (m_bExtractSEIMessage)
-    {
-        m_fpSEI = fopen("sei_message.txt", "wb");
-        m_pCurrSEIMessage = new CUVIDSEIMESSAGEINFO;
-        memset(&m_SEIMessagesDisplayOrder, 0, sizeof(m_SEIMessagesDisplayOrder));
-    }
+    m_seiTypeFilter.set();
+    CreateParser();
+}
+
+void NvDecoder::CreateParser()
+{
     CUVIDPARSERPARAMS videoParserParameters = {};
-    videoParserParameters.CodecType = eCodec;
+    videoParserParameters.CodecType = m_eCodec;
     videoParserParameters.ulMaxNumDecodeSurfaces = 1;
-    videoParserParameters.ulClockRate = clkRate;
-    videoParserParameters.ulMaxDisplayDelay = bLowLatency ? 0 : 1;
+    videoParserParameters.ulClockRate = m_nClockRate;
+    videoParserParameters.ulMaxDisplayDelay = m_nMaxDisplayDelay;
     videoParserParameters.pUserData = this;
     videoParserParameters.pfnSequenceCallback = HandleVideoSequenceProc;
     videoParserParameters.pfnDecodePicture = HandlePictureDecodeProc;
@@ -884,24 +1199,76 @@ NvDecoder::NvDecoder(CUstream cuStream,CUcontext cuContext, bool bUseDeviceFrame
     NVDEC_API_CALL(m_api.cuvidCreateVideoParser(&m_hParser, &videoParserParameters));
 }
 
-NvDecoder::~NvDecoder() {
+void NvDecoder::DestroyDecoderSession()
+{
+    CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
+    NVDEC_API_CALL(m_api.cuvidDestroyDecoder(m_hDecoder));
+    CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
+    m_hDecoder = NULL;
+    // the next sequence header takes the creation path
+    m_nWidth = m_nLumaHeight = m_nChromaHeight = 0;
+    m_nNumDecodeSurfaces = m_nCreatedDecodeSurfaces = 0;
+    m_videoFormat = {};
+    m_bReconfigExternal = false;
+    m_bReconfigExtPPChange = false;
+}
 
+void NvDecoder::Reset(cudaVideoCodec eCodec)
+{
     START_TIMER
-
-    if (m_pCurrSEIMessage) {
-        delete m_pCurrSEIMessage;
-        m_pCurrSEIMessage = NULL;
+    while (!m_vMappedFrame.empty())
+    {
+        CUdeviceptr dpFrame = m_vMappedFrame.front().dpFrame;
+        m_vMappedFrame.pop_front();
+        UnmapFrame(dpFrame);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+        if (m_nMappedFrame)
+        {
+            NVDEC_THROW_ERROR("Unmap all frames before resetting the decoder", CUDA_ERROR_NOT_READY);
+        }
+        m_nDecodedFrame = 0;
+        m_nDecodedFrameReturned = 0;
+        m_mapSubmitTime.clear();
+    }
+    for (SEIMessages& sei : m_aSEIPicture)
+    {
+        sei.clear();
     }
 
-    if (m_fpSEI) {
-        fclose(m_fpSEI);
-        m_fpSEI = NULL;
+    if (m_hParser)
+    {
+        m_api.cuvidDestroyVideoParser(m_hParser);
+        m_hParser = NULL;
     }
+    if (m_hDecoder && eCodec != m_eCodec)
+    {
+        DestroyDecoderSession();
+        m_nSessionRecreate++;
+    }
+    m_eCodec = eCodec;
+    m_nDecodePicCnt = 0;
+    m_bEndDecodeDone = false;
+    m_bResetPending = m_hDecoder != NULL;
+    CreateParser();
+    STOP_TIMER("Session Reset Time: ");
+    NvDecoder::addDecoderSessionOverHead(getDecoderSessionID(), elapsedTime);
+}
+
+NvDecoder::~NvDecoder() {
+
+    START_TIMER
 
     if (m_hParser) {
         m_api.cuvidDestroyVideoParser(m_hParser);
     }
     cuCtxPushCurrent(m_cuContext);
+    for (const MappedFrame& mappedFrame : m_vMappedFrame)
+    {
+        m_api.cuvidUnmapVideoFrame(m_hDecoder, mappedFrame.dpFrame);
+    }
+    m_vMappedFrame.clear();
     if (m_hDecoder) {
         m_api.cuvidDestroyDecoder(m_hDecoder);
     }
@@ -909,30 +1276,25 @@ NvDecoder::~NvDecoder() {
     std::lock_guard<std::mutex> lock(m_mtxVPFrame);
 
 
-    for (uint8_t *pFrame : m_vpFrame)
+    // Frees are ordered on the decoder stream after the pending copies, without waiting for other work
+    for (size_t i = 0; i < m_vFrame.size(); i++)
     {
-        if (m_bUseDeviceFrame)
-        {
-            if (m_bEnableAsyncAllocations)
-            {
-                CUDA_DRVAPI_CALL(cuMemFreeAsync((*(CUdeviceptr*)&pFrame), NULL));//sync on NULL stream to ensure that all work is completed before dtor
-            }
-            else
-            {
-                CUDA_DRVAPI_CALL(cuMemFree((CUdeviceptr)pFrame));
-            }
-            
-        }
-        else
-        {
-            delete[] pFrame;
-        }
+        FreeFrame(m_vFrame[i].pFrame);
     }
 
     if (m_bEnableAsyncAllocations)
     {
         CUDA_DRVAPI_CALL(cuEventDestroy(m_bCUEvent));
     }
+    for (CUevent hEvent : m_vHostCopyEvent)
+    {
+        CUDA_DRVAPI_CALL(cuEventDestroy(hEvent));
+    }
+    if (m_bDestroyStream)
+    {
+        // resources are released once the pending frees have completed
+        CUDA_DRVAPI_CALL(cuStreamDestroy(m_cuvidStream));
+    }
     
     cuCtxPopCurrent(NULL);
 
@@ -966,8 +1328,28 @@ void NvDecoder::CUStreamSyncOnEvent()
 int NvDecoder::Decode(const uint8_t *pData, int nSize, int nFlags, int64_t nTimestamp)
 {
     NVTX_SCOPED_RANGE("decodehelper::decodeframe")
+    // Mapped frames that were not fetched after the previous call are not referenced by the application
+    while (!m_vMappedFrame.empty())
+    {
+        CUdeviceptr dpFrame = m_vMappedFrame.front().dpFrame;
+        m_vMappedFrame.pop_front();
+        UnmapFrame(dpFrame);
+    }
+    WaitForOutputFrame();
     m_nDecodedFrame = 0;
     m_nDecodedFrameReturned = 0;
+    m_nFrameSEIFetched = 0;
+    m_tDecodeStart = std::chrono::steady_clock::now();
+    m_nPacketTimestamp = nTimestamp;
+    if (pData && nSize)
+    {
+        m_mapSubmitTime[nTimestamp] = m_tDecodeStart;
+        // packets of dropped frames are never looked up, keep the oldest timestamps bounded
+        while (m_mapSubmitTime.size() > 2 * MAX_FRM_CNT)
+        {
+            m_mapSubmitTime.erase(m_mapSubmitTime.begin());
+        }
+    }
     CUVIDSOURCEDATAPACKET packet = { 0 };
     packet.payload = pData;
     packet.payload_size = nSize;
@@ -981,37 +1363,140 @@ int NvDecoder::Decode(const uint8_t *pData, int nSize, int nFlags, int64_t nTime
     return m_nDecodedFrame;
 }
 
-uint8_t* NvDecoder::GetFrame(int64_t* pTimestamp)
+void NvDecoder::WaitForOutputFrame()
+{
+    std::unique_lock<std::mutex> lock(m_mtxVPFrame);
+    if (m_bZeroCopyOutput)
+    {
+        // Frames still mapped after the ones that were not fetched are unmapped are held by the application
+        auto surfaceAvailable = [this] { return m_nMappedFrame < (int)m_nNumOutputSurfaces; };
+        if (!surfaceAvailable())
+        {
+            if (!m_bWaitForFreeSurface)
+            {
+                NVDEC_THROW_ERROR("All decoder output surfaces are in use. Release decoded frames before decoding further", CUDA_ERROR_NOT_READY);
+            }
+            m_cvMappedFrame.wait(lock, [&] { return surfaceAvailable() || m_bFrameWaitCancelled; });
+            if (!surfaceAvailable())
+            {
+                NVDEC_THROW_ERROR("Waiting for a decoder output surface was cancelled", CUDA_ERROR_NOT_READY);
+            }
+        }
+    }
+    else if (m_nMaxFrameAlloc)
+    {
+        // Only leased frames count: the frames of the current call are allocated even when they exceed the limit,
+        // and UnlockFrame() frees the excess
+        auto frameAvailable = [this] { return (unsigned)m_nLockedFrame < m_nMaxFrameAlloc; };
+        if (!frameAvailable())
+        {
+            if (!m_bBlockOnFramePool)
+            {
+                NVDEC_THROW_ERROR("Decoded frame pool is exhausted. Release decoded frames before decoding further", CUDA_ERROR_OUT_OF_MEMORY);
+            }
+            m_cvFramePool.wait(lock, [&] { return frameAvailable() || m_bFrameWaitCancelled; });
+            if (!frameAvailable())
+            {
+                NVDEC_THROW_ERROR("Waiting for a decoded frame to return to the pool was cancelled", CUDA_ERROR_NOT_READY);
+            }
+        }
+    }
+}
+
+void NvDecoder::CancelFrameWait(bool bCancel)
 {
-    if (m_nDecodedFrame > 0)
     {
         std::lock_guard<std::mutex> lock(m_mtxVPFrame);
-        m_nDecodedFrame--;
+        m_bFrameWaitCancelled = bCancel;
+    }
+    m_cvMappedFrame.notify_all();
+    m_cvFramePool.notify_all();
+}
+
+uint8_t* NvDecoder::GetFrame(int64_t* pTimestamp, SEIMessages* pSEI)
+{
+    if (m_nDecodedFrame > 0)
+    {
+        FetchFrameSEI(pSEI);
+        FrameDesc frameDesc;
+        {
+            std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+            m_nDecodedFrame--;
+            frameDesc = m_vFrame[m_nDecodedFrameReturned++];
+        }
+        WaitForFrameCopy(frameDesc.hCopyEvent);
         if (pTimestamp)
-            *pTimestamp = m_vTimestamp[m_nDecodedFrameReturned];
-        return m_vpFrame[m_nDecodedFrameReturned++];
+            *pTimestamp = frameDesc.timestamp;
+        return frameDesc.pFrame;
     }
 
     return NULL;
 }
 
-uint8_t* NvDecoder::GetLockedFrame(int64_t* pTimestamp)
+CUdeviceptr NvDecoder::GetMappedFrame(unsigned int* pPitch, int64_t* pTimestamp, int64_t* pLatencyNs, SEIMessages* pSEI,
+    cuvidDecodeStatus* pDecodeStatus)
 {
-    uint8_t *pFrame;
-    uint64_t timestamp;
-    if (m_nDecodedFrame > 0) {
-        std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+    std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+    if (m_nDecodedFrame > 0 && !m_vMappedFrame.empty())
+    {
+        FetchFrameSEI(pSEI);
         m_nDecodedFrame--;
-        pFrame = m_vpFrame[0];
-        m_vpFrame.erase(m_vpFrame.begin(), m_vpFrame.begin() + 1);
-        
-        timestamp = m_vTimestamp[0];
-        m_vTimestamp.erase(m_vTimestamp.begin(), m_vTimestamp.begin() + 1);
-        
+        MappedFrame mappedFrame = m_vMappedFrame.front();
+        m_vMappedFrame.pop_front();
+        if (pPitch)
+            *pPitch = mappedFrame.nPitch;
         if (pTimestamp)
-            *pTimestamp = timestamp;
-        
-        return pFrame;
+            *pTimestamp = mappedFrame.timestamp;
+        if (pLatencyNs)
+            *pLatencyNs = mappedFrame.latencyNs;
+        if (pDecodeStatus)
+            *pDecodeStatus = mappedFrame.decodeStatus;
+        return mappedFrame.dpFrame;
+    }
+
+    return 0;
+}
+
+void NvDecoder::UnmapFrame(CUdeviceptr dpFrame)
+{
+    // Called from the deleters of zero-copy frames, on whichever thread releases them
+    CUDA_DRVAPI_CALL(cuCtxPushCurrent(m_cuContext));
+    CUresult result = m_api.cuvidUnmapVideoFrame(m_hDecoder, dpFrame);
+    CUDA_DRVAPI_CALL(cuCtxPopCurrent(NULL));
+    {
+        std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+        m_nMappedFrame--;
+    }
+    m_cvMappedFrame.notify_one();
+    if (result != CUDA_SUCCESS)
+    {
+        NVDEC_THROW_ERROR("cuvidUnmapVideoFrame failed", result);
+    }
+}
+
+uint8_t* NvDecoder::GetLockedFrame(int64_t* pTimestamp, cuvidDecodeStatus* pDecodeStatus, int64_t* pLatencyNs, SEIMessages* pSEI)
+{
+    if (m_nDecodedFrame > 0) {
+        FetchFrameSEI(pSEI);
+        FrameDesc frameDesc;
+        {
+            std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+            m_nDecodedFrame--;
+            frameDesc = m_vFrame.front();
+            m_vFrame.pop_front();
+            m_setLockedFrame.insert(frameDesc.pFrame);
+            m_nLockedFrameHighWater = (std::max)(m_nLockedFrameHighWater, ++m_nLockedFrame);
+        }
+        WaitForFrameCopy(frameDesc.hCopyEvent);
+
+        if (pTimestamp)
+            *pTimestamp = frameDesc.timestamp;
+        if (pDecodeStatus)
+            *pDecodeStatus = frameDesc.decodeStatus;
+        if (pLatencyNs)
+            *pLatencyNs = frameDesc.latencyNs;
+
+        return frameDesc.pFrame;
     }
 
     return NULL;
@@ -1019,20 +1504,41 @@ uint8_t* NvDecoder::GetLockedFrame(int64_t* pTimestamp)
 
 void NvDecoder::UnlockFrame(uint8_t **pFrame)
 {
-    std::lock_guard<std::mutex> lock(m_mtxVPFrame);
-    m_vpFrame.insert(m_vpFrame.end(), &pFrame[0], &pFrame[1]);
-    
-    // add a dummy entry for timestamp
-    uint64_t timestamp[2] = {0};
-    m_vTimestamp.insert(m_vTimestamp.end(), &timestamp[0], &timestamp[1]);
+    UnlockFrame(pFrame[0]);
 }
 
 void NvDecoder::UnlockFrame(uint8_t* pFrame)
 {
-    std::lock_guard<std::mutex> lock(m_mtxVPFrame);
-    m_vpFrame.insert(m_vpFrame.end(), pFrame);
+    bool bStale = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+        m_setLockedFrame.erase(pFrame);
+        m_nLockedFrame--;
+        bStale = m_setStaleFrame.erase(pFrame) > 0;
+        if (!bStale && m_nMaxFrameAlloc && (unsigned)m_nFrameAlloc > m_nMaxFrameAlloc)
+        {
+            // allocated beyond the limit by a call that output more frames than the pool holds
+            bStale = true;
+        }
+        if (bStale)
+        {
+            m_nFrameAlloc--;
+        }
+        else
+        {
+            m_vFrame.push_back({ pFrame, 0, cuvidDecodeStatus_Invalid });
+        }
+    }
+    if (bStale)
+    {
+        FreeFrame(pFrame);
+    }
+    m_cvFramePool.notify_one();
+}
 
-    // add a dummy entry for timestamp
-    uint64_t timestamp[1] = { 0 };
-    m_vTimestamp.insert(m_vTimestamp.end(), timestamp[0]);
+void NvDecoder::SetFramePoolLimit(unsigned int nMaxFrames, bool bBlocking)
+{
+    std::lock_guard<std::mutex> lock(m_mtxVPFrame);
+    m_nMaxFrameAlloc = nMaxFrames;
+    m_bBlockOnFramePool = bBlocking;
 }
\ No newline at end of file
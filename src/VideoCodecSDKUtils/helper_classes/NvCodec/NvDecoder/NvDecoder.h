@@ -27,7 +27,12 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <unordered_set>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -37,9 +42,12 @@
 #include "../Utils/NvCodecUtils.h"
 #include "cuvidFunctions.h"
 #include <map>
+#include <bitset>
 #include "functional"
 
 #define MAX_FRM_CNT 32
+// maximum ulNumOutputSurfaces accepted by cuvidCreateDecoder
+#define MAX_OUTPUT_SURFACE_CNT 64
 
 typedef enum{
     SEI_TYPE_TIME_CODE = 136,
@@ -102,6 +110,15 @@ struct Dim {
     int w, h;
 };
 
+/**
+* @brief SEI messages of a decoded frame. The payloads are stored back to back in data, in the order of messages.
+*/
+struct SEIMessages {
+    std::vector<CUSEIMESSAGE> messages;
+    std::vector<uint8_t> data;
+    void clear() { messages.clear(); data.clear(); }
+};
+
 /**
 * @brief Base class for decoder interface.
 */
@@ -117,7 +134,8 @@ public:
               bool bLowLatency = false, bool bEnableAsyncAllocations = false,bool bDestroyContext = false,
               bool bDeviceFramePitched = false, const Rect *pCropRect = NULL, const Dim *pResizeDim = NULL,
               bool extract_user_SEI_Message = false, int maxWidth = 0, int maxHeight = 0, unsigned int clkRate = 1000,
-              bool force_zero_latency = false
+              bool force_zero_latency = false, bool bZeroCopyOutput = false, bool bWaitForFreeSurface = false,
+              unsigned int nNumOutputSurfaces = 2, unsigned int nExtraDecodeSurfaces = 0, int nMaxDisplayDelay = -1
               );
 
     ~NvDecoder();
@@ -144,9 +162,10 @@ public:
 
     /**
     *  @brief  This function is used to get the output frame width.
-    *  NV12/P016 output format width is 2 byte aligned because of U and V interleave
+    *  NV12/P016/NV16/P216 output format width is 2 byte aligned because of U and V interleave
     */
-    int GetWidth() { assert(m_nWidth); return (m_eOutputFormat == cudaVideoSurfaceFormat_NV12 || m_eOutputFormat == cudaVideoSurfaceFormat_P016) 
+    int GetWidth() { assert(m_nWidth); return (m_eOutputFormat == cudaVideoSurfaceFormat_NV12 || m_eOutputFormat == cudaVideoSurfaceFormat_P016
+                                                || m_eOutputFormat == cudaVideoSurfaceFormat_NV16 || m_eOutputFormat == cudaVideoSurfaceFormat_P216)
                                                 ? (m_nWidth + 1) & ~1 : m_nWidth; }
 
     /**
@@ -204,6 +223,32 @@ public:
     */
     cudaVideoSurfaceFormat GetOutputFormat() { return m_eOutputFormat; }
 
+    /**
+    *   @brief  This function is used to get the codec and the chroma format of the bitstream
+    */
+    cudaVideoCodec GetCodec() { return m_eCodec; }
+    cudaVideoChromaFormat GetChromaFormat() { return m_eChromaFormat; }
+
+    /**
+    *   @brief  This function returns true once a decoder session has been created by a sequence header
+    */
+    bool HasDecoderSession() { return m_hDecoder != NULL; }
+
+    /**
+    *   @brief  This function prepares the decoder for a new bitstream. The parser is recreated and frames that were
+    *   decoded but not fetched are dropped. The decoder session and frame stock are kept and reconfigured at the next
+    *   sequence header when the codec, chroma format and bit depth match and the coded size fits the maximum size
+    *   of the session; otherwise the session is recreated. Mapped frames must be unmapped before the call.
+    *   @param  eCodec - codec of the new bitstream
+    */
+    void Reset(cudaVideoCodec eCodec);
+
+    /**
+    *   @brief  This function is used to get the number of times the decoder session was reused by Reset() and recreated
+    */
+    int GetNumSessionReuses() { return m_nSessionReuse; }
+    int GetNumSessionRecreations() { return m_nSessionRecreate; }
+
     /**
     *   @brief  This function is used to get information about the video stream (codec, display parameters etc)
     */
@@ -232,8 +277,10 @@ public:
     /**
     *   @brief  This function returns a decoded frame and timestamp. This function should be called in a loop for
     *   fetching all the frames that are available for display.
+    *   The SEI messages of the frame are swapped into pSEI when SEI extraction is enabled; the buffers previously
+    *   held by pSEI are reused by the decoder. The same applies to GetLockedFrame() and GetMappedFrame().
     */
-    uint8_t* GetFrame(int64_t* pTimestamp = nullptr);
+    uint8_t* GetFrame(int64_t* pTimestamp = nullptr, SEIMessages* pSEI = nullptr);
 
 
     /**
@@ -242,7 +289,8 @@ public:
     *   getting overwritten, even if subsequent decode calls are made. The frame buffers
     *   remain locked, until UnlockFrame() is called
     */
-    uint8_t* GetLockedFrame(int64_t* pTimestamp = nullptr);
+    uint8_t* GetLockedFrame(int64_t* pTimestamp = nullptr, cuvidDecodeStatus* pDecodeStatus = nullptr, int64_t* pLatencyNs = nullptr,
+        SEIMessages* pSEI = nullptr);
 
     /**
     *   @brief  This function unlocks the frame buffer and makes the frame buffers available for write again
@@ -257,6 +305,182 @@ public:
     */
     void UnlockFrame(uint8_t* pFrame);
 
+    /**
+    *   @brief  This function bounds the number of frames the decoder allocates for its stock. Decode() only parses
+    *   a packet while fewer frames are held through GetLockedFrame(). A call outputting more frames than the limit
+    *   allocates the excess, which UnlockFrame() frees.
+    *   @param  nMaxFrames - maximum number of allocated frames, 0 for no limit
+    *   @param  bBlocking - make Decode() wait for UnlockFrame() when the limit is reached instead of throwing
+    */
+    void SetFramePoolLimit(unsigned int nMaxFrames, bool bBlocking);
+
+    /**
+    *   @brief  This function wakes a Decode() call waiting for the application to release frames, which then throws.
+    *   Decode() throws instead of waiting until waiting is allowed again.
+    *   @param  bCancel - cancel the current and future waits if true, allow waiting again if false
+    */
+    void CancelFrameWait(bool bCancel);
+
+    /**
+    *   @brief  This function is used to get the number of decoded frames written to a frame already in stock
+    */
+    int GetFramePoolHits() { std::lock_guard<std::mutex> lock(m_mtxVPFrame); return m_nFramePoolHit; }
+
+    /**
+    *   @brief  This function is used to get the number of decoded frames that required a new allocation
+    */
+    int GetFramePoolMisses() { std::lock_guard<std::mutex> lock(m_mtxVPFrame); return m_nFramePoolMiss; }
+
+    /**
+    *   @brief  This function is used to get the number of frames currently locked by the application
+    */
+    int GetNumLockedFrames() { std::lock_guard<std::mutex> lock(m_mtxVPFrame); return m_nLockedFrame; }
+
+    /**
+    *   @brief  This function is used to get the highest number of frames locked by the application at once
+    */
+    int GetLockedFramesHighWater() { std::lock_guard<std::mutex> lock(m_mtxVPFrame); return m_nLockedFrameHighWater; }
+
+    /**
+    *   @brief  This function sets the number of frames allocated for the stock as soon as the output size is known,
+    *   at the sequence header and when the decoder is reconfigured, instead of on first use. The count is capped
+    *   by the frame pool limit. No frames are allocated in zero-copy mode.
+    *   @param  nFrames - number of frames to allocate, 0 to allocate on demand, -1 for one frame per decode surface
+    */
+    void SetFramePreallocation(int nFrames) { std::lock_guard<std::mutex> lock(m_mtxVPFrame); m_nPreallocFrame = nFrames; }
+
+    /**
+    *   @brief  This function selects the stream-ordered memory pool the frames are allocated from when asynchronous
+    *   allocations are enabled. Frames already allocated stay in their pool and are freed to it.
+    *   @param  hMemPool - memory pool of the decoder device, NULL for the current pool of the device
+    */
+    void SetMemoryPool(CUmemoryPool hMemPool) { std::lock_guard<std::mutex> lock(m_mtxVPFrame); m_hMemPool = hMemPool; }
+
+    /**
+    *   @brief  This function selects page-locked host memory for the frames when they are not kept in device memory.
+    *   The copies to pinned frames are asynchronous and overlap with the decode of the next pictures; a frame
+    *   is waited for when it is returned by GetFrame() or GetLockedFrame(). Must be called before the first frame
+    *   is allocated.
+    */
+    void SetPinnedHostFrames(bool bPinned);
+
+    /**
+    *   @brief  This function is used to check whether host frames are allocated in page-locked memory
+    */
+    bool IsPinnedHostFrames() { return !m_bUseDeviceFrame && m_bPinnedHostFrame; }
+
+    /**
+    *   @brief  This function sets which frames with decode errors are dropped. Dropped frames are unmapped before
+    *   they are copied or handed out, and counted by GetDroppedFrameCount().
+    *   @param  bDropError - drop frames decoded with an error that was not concealed
+    *   @param  bDropConcealed - drop frames whose errors were concealed by the decoder
+    */
+    void SetErrorFramePolicy(bool bDropError, bool bDropConcealed) { m_bDropErrorFrame = bDropError; m_bDropConcealedFrame = bDropConcealed; }
+
+    /**
+    *   @brief  This function is used to get the number of frames decoded with errors, with concealed errors, and dropped
+    */
+    int GetDecodeErrorCount() { std::lock_guard<std::mutex> lock(m_mtxVPFrame); return m_nDecodeError; }
+    int GetDecodeConcealedCount() { std::lock_guard<std::mutex> lock(m_mtxVPFrame); return m_nDecodeConcealed; }
+    int GetDroppedFrameCount() { std::lock_guard<std::mutex> lock(m_mtxVPFrame); return m_nDroppedFrame; }
+
+    /**
+    *   @brief  This function is used to get the number of times the decoder session was reconfigured
+    */
+    int GetReconfigureCount() { return m_nReconfigure; }
+
+    /**
+    *   @brief  This function sets which pictures are parsed but not decoded, e.g. for previews and thumbnails.
+    *   Skipped pictures are not output and are counted by GetSkippedPictureCount(). The second field of a
+    *   picture follows the decision made for its first field.
+    *   @param  bSkipNonReference - skip the pictures no other picture refers to
+    *   @param  bSkipNonIntra - skip every picture but intra pictures
+    */
+    void SetPictureSkipMode(bool bSkipNonReference, bool bSkipNonIntra) { m_bSkipNonReference = bSkipNonReference; m_bSkipNonIntra = bSkipNonIntra; }
+
+    /**
+    *   @brief  This function is used to get the number of pictures skipped without being decoded
+    */
+    int GetSkippedPictureCount() { return m_nSkippedPicture; }
+
+    /**
+    *   @brief  This function selects the SEI payload types kept when SEI extraction is enabled. Messages of other
+    *   types are skipped by the parser callback without being copied.
+    *   @param  vTypes - SEI payload types to keep, all types if empty
+    */
+    void SetSEIMessageFilter(const std::vector<int>& vTypes);
+
+    /**
+    *   @brief  This function is used to get the number of frames currently allocated, including the locked frames
+    */
+    int GetNumAllocatedFrames() { std::lock_guard<std::mutex> lock(m_mtxVPFrame); return m_nFrameAlloc; }
+
+    /**
+    *   @brief  This function is used to get the total number of frame allocations and frees since the decoder was created
+    */
+    int GetFrameAllocCount() { return m_nFrameAllocCount; }
+    int GetFrameFreeCount() { return m_nFrameFreeCount; }
+
+    /**
+    *   @brief  This function is used to get the number of frames allocated ahead of decoding
+    */
+    int GetPreallocatedFrameCount() { std::lock_guard<std::mutex> lock(m_mtxVPFrame); return m_nPreallocFrameCount; }
+
+    /**
+    *   @brief  This function returns a decoded frame that is still mapped in the decoder output surface, along with
+    *   its pitch and timestamp. Only valid when zero-copy output is enabled. The surface stays mapped, and is not
+    *   available to the decoder, until UnmapFrame() is called.
+    *   @param  pPitch - pitch of the mapped surface in bytes
+    *   @param  pTimestamp - presentation timestamp of the frame
+    *   @param  pLatencyNs - time from the submission of the packet holding the frame to the frame being output
+    *   @param  pSEI - SEI messages of the frame
+    *   @param  pDecodeStatus - decode status of the frame
+    */
+    CUdeviceptr GetMappedFrame(unsigned int* pPitch, int64_t* pTimestamp = nullptr, int64_t* pLatencyNs = nullptr,
+        SEIMessages* pSEI = nullptr, cuvidDecodeStatus* pDecodeStatus = nullptr);
+
+    /**
+    *   @brief  This function unmaps a surface returned by GetMappedFrame() and gives it back to the decoder
+    *   @param  dpFrame - device pointer returned by GetMappedFrame()
+    */
+    void UnmapFrame(CUdeviceptr dpFrame);
+
+    /**
+    *   @brief  This function returns true if decoded frames are handed out as mapped decoder surfaces
+    */
+    bool IsZeroCopyOutput() { return m_bZeroCopyOutput; }
+
+    /**
+    *   @brief  This function is used to check whether decoded frames are copied to device memory or to host memory
+    */
+    bool IsDeviceFrameOutput() { return m_bUseDeviceFrame; }
+
+    /**
+    *   @brief  This function is used to get the number of rows between the planes of a mapped surface.
+    *   NVDEC output has luma height aligned by 2.
+    */
+    int GetMappedPlaneHeight() { assert(m_nSurfaceHeight); return (m_nSurfaceHeight + 1) & ~1; }
+
+    /**
+    *   @brief  This function is used to get the number of surfaces currently mapped by the application
+    */
+    int GetNumMappedFrames() { std::lock_guard<std::mutex> lock(m_mtxVPFrame); return m_nMappedFrame; }
+
+    /**
+    *   @brief  This function is used to get the number of output surfaces of the decoder
+    */
+    unsigned int GetNumOutputSurfaces() { return m_nNumOutputSurfaces; }
+
+    /**
+    *   @brief  This function is used to get the number of decode surfaces, 0 before the first sequence header
+    */
+    int GetNumDecodeSurfaces() { return m_nNumDecodeSurfaces; }
+
+    /**
+    *   @brief  This function is used to get the maximum display delay of the parser
+    */
+    unsigned int GetMaxDisplayDelay() { return m_nMaxDisplayDelay; }
+
     /**
     *   @brief  This function allows app to set decoder reconfig params
     *   @param  pCropRect - cropping rectangle coordinates
@@ -291,9 +515,22 @@ public:
     */
     std::vector<std::tuple<CUdeviceptr, int64_t>> Decode(uint8_t* , uint64_t);
 
+    /**
+    *   @brief  This function returns the decoder capabilities of a device for a codec, chroma format and bit depth.
+    *   The driver is only queried once per process for each combination, later calls are served from a cache.
+    *   @param  api - cuvid functions used for the query
+    *   @param  cuDevice - device the capabilities are queried for
+    *   @param  cuContext - context of the device pushed for the query, NULL to use the primary context of the device
+    */
+    static CUVIDDECODECAPS GetDecoderCaps(CuvidFunctions& api, CUdevice cuDevice, CUcontext cuContext,
+        cudaVideoCodec eCodec, cudaVideoChromaFormat eChromaFormat, unsigned int nBitDepthMinus8);
+
 private:
     int decoderSessionID; // Decoder session identifier. Used to gather session level stats.
     static std::map<int, int64_t> sessionOverHead; // Records session overhead of initialization+deinitialization time. Format is (thread id, duration)
+    // Decoder capabilities by device, codec, chroma format and bit depth
+    static std::map<std::tuple<CUdevice, cudaVideoCodec, cudaVideoChromaFormat, unsigned int>, CUVIDDECODECAPS> decoderCapsCache;
+    static std::mutex decoderCapsMutex;
 
     /**
     *   @brief  Callback function to be registered for getting a callback when decoding of sequence starts
@@ -353,9 +590,53 @@ private:
     */
     int ReconfigureDecoder(CUVIDEOFORMAT *pVideoFormat);
 
+    /**
+    *   @brief  Allocates and frees a decoded frame of the current output size
+    */
+    uint8_t* AllocFrame();
+    void FreeFrame(uint8_t *pFrame);
+
+    /**
+    *   @brief  Waits for the asynchronous copy into a pinned host frame to complete
+    */
+    void WaitForFrameCopy(CUevent hCopyEvent);
+
+    /**
+    *   @brief  Applies back-pressure on the frames held by the application before a packet is parsed. Waiting in
+    *   the display callback instead would block the only thread that fetches the frames of the current call.
+    */
+    void WaitForOutputFrame();
+
+    /**
+    *   @brief  Drops the frames in stock after the output size changed. Must be called with m_mtxVPFrame held
+    */
+    void ReleaseFrameStock();
+
+    /**
+    *   @brief  Keeps the frames in stock when the current output fits in them, and drops them otherwise.
+    *   Must be called with m_mtxVPFrame held
+    */
+    void ResizeFrameStock();
+
+    /**
+    *   @brief  Tops the frame stock up to the preallocation count
+    */
+    void PreallocateFrames();
+
+    /**
+    *   @brief  Creates the bitstream parser
+    */
+    void CreateParser();
+
+    /**
+    *   @brief  Destroys the decoder session so that the next sequence header creates a new one
+    */
+    void DestroyDecoderSession();
+
 
 private:
     CUcontext m_cuContext = NULL;
+    CUdevice m_cuDevice = 0;
     CUvideoctxlock m_ctxLock;
     CUvideoparser m_hParser = NULL;
     CUvideodecoder m_hDecoder = NULL;
@@ -373,19 +654,70 @@ private:
     int m_nBPP = 1;
     CUVIDEOFORMAT m_videoFormat = {};
     Rect m_displayRect = {};
-    // stock of frames
-    std::vector<uint8_t *> m_vpFrame;
-    // timestamps of decoded frames
-    std::vector<int64_t> m_vTimestamp;
+    // stock of frames. The first m_nDecodedFrame entries hold the frames decoded by the current Decode() call,
+    // locked frames are taken from the front and unlocked frames are returned to the back
+    struct FrameDesc {
+        uint8_t *pFrame;
+        int64_t timestamp;
+        cuvidDecodeStatus decodeStatus;
+        int64_t latencyNs;
+        // recorded after the copy into a pinned host frame, NULL when the copy has completed on return
+        CUevent hCopyEvent;
+    };
+    RingBuffer<FrameDesc> m_vFrame;
+    // surfaces mapped in zero-copy mode that have not been fetched yet
+    struct MappedFrame {
+        CUdeviceptr dpFrame;
+        unsigned int nPitch;
+        int64_t timestamp;
+        int64_t latencyNs;
+        cuvidDecodeStatus decodeStatus;
+    };
+    // submission time of the packets whose frames have not been output yet, by packet timestamp
+    std::map<int64_t, std::chrono::steady_clock::time_point> m_mapSubmitTime;
+    std::chrono::steady_clock::time_point m_tDecodeStart;
+    int64_t m_nPacketTimestamp = 0;
+    int64_t GetDecodeLatency(int64_t timestamp);
+    std::deque<MappedFrame> m_vMappedFrame;
     int m_nDecodedFrame = 0, m_nDecodedFrameReturned = 0;
     int m_nDecodePicCnt = 0, m_nPicNumInDecodeOrder[MAX_FRM_CNT];
-    CUVIDSEIMESSAGEINFO *m_pCurrSEIMessage = NULL;
-    CUVIDSEIMESSAGEINFO m_SEIMessagesDisplayOrder[MAX_FRM_CNT];
-    FILE *m_fpSEI = NULL;
+    // SEI messages parsed for each decode surface, and those of the frames output by the current Decode() call
+    // in output order. Buffers are swapped between the two instead of being copied, so their capacity is reused.
+    SEIMessages m_aSEIPicture[MAX_FRM_CNT];
+    std::vector<SEIMessages> m_vFrameSEI;
+    int m_nFrameSEIFetched = 0;
+    std::bitset<256> m_seiTypeFilter;
+    void FetchFrameSEI(SEIMessages* pSEI);
     bool m_bEndDecodeDone = false;
     std::mutex m_mtxVPFrame;
     int m_nFrameAlloc = 0;
+    // frame pool limit and counters. m_nFrameAlloc is the number of frames currently allocated
+    unsigned int m_nMaxFrameAlloc = 0;
+    bool m_bBlockOnFramePool = false;
+    // set by CancelFrameWait() to release a Decode() call blocked on frames held by the application
+    bool m_bFrameWaitCancelled = false;
+    int m_nFramePoolHit = 0, m_nFramePoolMiss = 0;
+    int m_nLockedFrame = 0, m_nLockedFrameHighWater = 0;
+    // frames allocated when the output size is known, 0 for none and -1 for one per decode surface
+    int m_nPreallocFrame = 0, m_nPreallocFrameCount = 0;
+    // allocation counters, updated by AllocFrame() and FreeFrame() which may run without m_mtxVPFrame
+    std::atomic<int> m_nFrameAllocCount{0}, m_nFrameFreeCount{0};
+    // row size in bytes and number of rows the frames in stock were allocated with. Frames are kept
+    // when the output shrinks, and only reallocated when the output no longer fits.
+    size_t m_nFrameRowBytes = 0;
+    unsigned int m_nFrameRows = 0;
+    std::condition_variable m_cvFramePool;
+    // frames held by the application, and frames allocated before the output size changed
+    // that are freed instead of being returned to the stock
+    std::unordered_set<uint8_t*> m_setLockedFrame, m_setStaleFrame;
     CUstream m_cuvidStream = 0;
+    // stream created by the decoder for asynchronous allocations when the application did not pass one
+    bool m_bDestroyStream = false;
+    CUmemoryPool m_hMemPool = NULL;
+    bool m_bPinnedHostFrame = false;
+    // copy events of the frames output by a Decode() call, indexed by output order. An event is recorded again
+    // by a later call only, after the frame it belonged to has been fetched.
+    std::vector<CUevent> m_vHostCopyEvent;
     bool m_bDeviceFramePitched = false;
     size_t m_nDeviceFramePitch = 0;
     Rect m_cropRect = {};
@@ -410,4 +742,32 @@ private:
     CUevent m_bCUEvent = NULL;
     bool m_bEnableAsyncAllocations = false;
     bool m_bDestroyContext = false;
+    // In zero-copy mode frames are not copied out of the decoder output surfaces; the surfaces remain mapped
+    // until the application unmaps them. Decode() only parses a packet while the application holds fewer than
+    // m_nNumOutputSurfaces mapped frames; the session has one more output surface per decode surface, so that
+    // every picture a single call outputs can be mapped as well.
+    bool m_bZeroCopyOutput = false;
+    bool m_bWaitForFreeSurface = false;
+    unsigned int m_nNumOutputSurfaces = 2;
+    // decode surfaces allocated on top of the minimum required by the stream, and the resulting count
+    unsigned int m_nExtraDecodeSurfaces = 0;
+    int m_nNumDecodeSurfaces = 0;
+    unsigned int m_nMaxDisplayDelay = 1;
+    int m_nMappedFrame = 0;
+    std::condition_variable m_cvMappedFrame;
+    unsigned int m_nClockRate = 1000;
+    // set by Reset() until the sequence header of the new bitstream decides between reconfiguring and recreating
+    bool m_bResetPending = false;
+    // decode surfaces the session was created with, the most a reconfigure can use
+    int m_nCreatedDecodeSurfaces = 0;
+    unsigned int m_nCreatedOutputSurfaces = 0;
+    int m_nSessionReuse = 0, m_nSessionRecreate = 0;
+    // decode status policy and counters
+    bool m_bDropErrorFrame = false, m_bDropConcealedFrame = false;
+    int m_nDecodeError = 0, m_nDecodeConcealed = 0, m_nDroppedFrame = 0;
+    int m_nReconfigure = 0;
+    // pictures parsed but not decoded, and the decode surfaces that hold no picture because of it
+    bool m_bSkipNonReference = false, m_bSkipNonIntra = false;
+    bool m_abSkippedPicture[MAX_FRM_CNT] = {};
+    int m_nSkippedPicture = 0;
 };
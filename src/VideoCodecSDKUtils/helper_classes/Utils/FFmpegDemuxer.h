@@ -158,6 +158,12 @@ public:
     public:
         virtual ~DataProvider() {}
         virtual int GetData(uint8_t *pBuf, int nBuf) = 0;
+        /**
+        *   @brief  Repositions the stream like fseek() and returns the new position, or returns the stream size
+        *   when whence is AVSEEK_SIZE. Returns a negative value on failure. Only called if IsSeekable().
+        */
+        virtual int64_t Seek(int64_t offset, int whence) { return -1; }
+        virtual bool IsSeekable() { return false; }
     };
 
 private:
@@ -325,7 +331,7 @@ private:
         is_seekable = fmtc->iformat->read_seek || fmtc->iformat->read_seek2;
     }
 
-    AVFormatContext *CreateFormatContext(DataProvider *pDataProvider) {
+    AVFormatContext *CreateFormatContext(DataProvider *pDataProvider, int nAvioBufferSize) {
 
         AVFormatContext *ctx = NULL;
         if (!(ctx = avformat_alloc_context())) {
@@ -334,14 +340,14 @@ private:
         }
 
         uint8_t *avioc_buffer = NULL;
-        int avioc_buffer_size = 8 * 1024 * 1024;
+        int avioc_buffer_size = nAvioBufferSize;
         avioc_buffer = (uint8_t *)av_malloc(avioc_buffer_size);
         if (!avioc_buffer) {
             LOG(ERROR) << "FFmpeg error: " << __FILE__ << " " << __LINE__;
             return NULL;
         }
         avioc = avio_alloc_context(avioc_buffer, avioc_buffer_size,
-            0, pDataProvider, &ReadPacket, NULL, NULL);
+            0, pDataProvider, &ReadPacket, NULL, pDataProvider->IsSeekable() ? &SeekPacket : NULL);
         if (!avioc) {
             LOG(ERROR) << "FFmpeg error: " << __FILE__ << " " << __LINE__;
             return NULL;
@@ -367,7 +373,7 @@ private:
 
 public:
     FFmpegDemuxer(const char *szFilePath, int64_t timescale = 1000 /*Hz*/) : FFmpegDemuxer(CreateFormatContext(szFilePath), timescale) {}
-    FFmpegDemuxer(DataProvider *pDataProvider) : FFmpegDemuxer(CreateFormatContext(pDataProvider)) {avioc = fmtc->pb;}
+    FFmpegDemuxer(DataProvider *pDataProvider, int nAvioBufferSize = 8 * 1024 * 1024) : FFmpegDemuxer(CreateFormatContext(pDataProvider, nAvioBufferSize)) {avioc = fmtc->pb;}
     ~FFmpegDemuxer() {
 
         if (!fmtc) {
@@ -426,6 +432,8 @@ public:
 
     AVColorRange GetColorRange() const { return color_range; }
 
+    AVRational GetTimeBase() const { return fmtc->streams[iVideoStream]->time_base; }
+
     bool IsVFR() const { 
         return framerate != avg_framerate; 
     }
@@ -515,6 +523,88 @@ public:
         return true;
     }
 
+    /**
+    *   @brief  Reads the next video packet without filtering it and returns its metadata. Used to index a stream.
+    */
+    bool ReadPacketInfo(int64_t *pPos, int64_t *pPts, int64_t *pDts, int *pnSize, bool *pbKey) {
+        if (!fmtc) {
+            return false;
+        }
+
+        if (pkt->data) {
+            av_packet_unref(pkt);
+        }
+
+        int e = 0;
+        while ((e = av_read_frame(fmtc, pkt)) >= 0 && pkt->stream_index != iVideoStream) {
+            av_packet_unref(pkt);
+        }
+        if (e < 0) {
+            return false;
+        }
+
+        *pPos = pkt->pos;
+        *pPts = pkt->pts;
+        *pDts = pkt->dts;
+        *pnSize = pkt->size;
+        *pbKey = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
+        return true;
+    }
+
+    /**
+    *   @brief  Seeks to the key frame with the given dts, or to an earlier key frame if the container index is
+    *   coarser. The caller demuxes forward until it reaches the packet with that dts.
+    */
+    bool SeekToKeyFrame(int64_t dts) {
+        if (!is_seekable) {
+            return false;
+        }
+        if (av_seek_frame(fmtc, iVideoStream, dts, AVSEEK_FLAG_BACKWARD) < 0) {
+            return false;
+        }
+        if (bsfc) {
+            av_bsf_flush(bsfc);
+        }
+        return true;
+    }
+
+    /**
+    *   @brief  Fills pPacketData with the bitstream and metadata of the packet returned by the last Demux() call.
+    *   Timestamps are in the stream time base. pPacketData holds its own reference on the packet buffer, so the data
+    *   stays valid across subsequent Demux() calls without being copied.
+    */
+    void GetPacketData(PacketData *pPacketData) {
+        AVPacket *pktSrc = (bMp4H264 || bMp4HEVC) ? pktFiltered : pkt;
+        AVPacket *pktRef = NULL;
+        if (bMp4MPEG4 && frameCount == 1 && pDataWithHeader) {
+            // First MPEG4 packet is rebuilt with the extradata prepended and is not backed by an AVBufferRef
+            int nSize = fmtc->streams[iVideoStream]->codecpar->extradata_size + pktSrc->size - 3;
+            pktRef = av_packet_alloc();
+            if (!pktRef || av_new_packet(pktRef, nSize) < 0) {
+                av_packet_free(&pktRef);
+                throw std::runtime_error("AVPacket allocation failed");
+            }
+            memcpy(pktRef->data, pDataWithHeader, nSize);
+            av_packet_copy_props(pktRef, pktSrc);
+        } else {
+            pktRef = av_packet_clone(pktSrc);
+            if (!pktRef) {
+                throw std::runtime_error("AVPacket reference failed");
+            }
+        }
+
+        pPacketData->key = (pktRef->flags & AV_PKT_FLAG_KEY) ? 1 : 0;
+        pPacketData->pts = pktRef->pts;
+        pPacketData->dts = pktRef->dts;
+        pPacketData->pos = pktRef->pos;
+        pPacketData->duration = pktRef->duration;
+        pPacketData->time_base_num = fmtc->streams[iVideoStream]->time_base.num;
+        pPacketData->time_base_den = fmtc->streams[iVideoStream]->time_base.den;
+        pPacketData->bsl_data = (uintptr_t)pktRef->data;
+        pPacketData->bsl = pktRef->size;
+        pPacketData->owner.reset(pktRef, [](AVPacket *p) { av_packet_free(&p); });
+    }
+
     bool Seek(SeekContext& seekCtx, uint8_t** ppVideo, int* pnVideoBytes)
     {
         
@@ -673,6 +763,10 @@ public:
         return ((DataProvider *)opaque)->GetData(pBuf, nBuf);
     }
 
+    static int64_t SeekPacket(void *opaque, int64_t offset, int whence) {
+        return ((DataProvider *)opaque)->Seek(offset, whence & ~AVSEEK_FORCE);
+    }
+
 };
 
 #ifndef DEMUX_ONLY
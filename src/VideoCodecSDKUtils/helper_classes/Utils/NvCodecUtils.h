@@ -42,6 +42,7 @@
 #include <sstream>
 #include <thread>
 #include <list>
+#include <memory>
 #include <vector>
 #include <condition_variable>
 #ifndef DEMUX_ONLY
@@ -52,13 +53,16 @@ extern simplelogger::Logger *logger;
 
 
 struct PacketData {
-    int32_t key;
-    int64_t pts;
-    int64_t dts;
-    uint64_t pos;
-    uintptr_t bsl_data;
-    uint64_t bsl;
-    uint64_t duration;
+    int32_t key = 0;
+    int64_t pts = 0;
+    int64_t dts = 0;
+    uint64_t pos = 0;
+    uintptr_t bsl_data = 0;
+    uint64_t bsl = 0;
+    uint64_t duration = 0;
+    int32_t time_base_num = 0; // pts, dts and duration are in units of time_base_num / time_base_den seconds
+    int32_t time_base_den = 0;
+    std::shared_ptr<void> owner; // keeps bsl_data alive, e.g. a reference on the demuxed AVPacket
 };
 
 #ifdef __cuda_cuda_h__
@@ -508,7 +512,59 @@ private:
     std::list<T> m_List;
     std::mutex m_mutex;
     std::condition_variable m_cond;
-    size_t maxSize;
+    size_t maxSize = 0;
+};
+
+/**
+* @brief Ring buffer with constant time push and pop at both ends and indexed access from the front.
+* The capacity is a power of two and doubles when the buffer is full. Not thread safe.
+*/
+template<typename T>
+class RingBuffer
+{
+public:
+    RingBuffer(size_t capacity = 16) : m_vElements(1) {
+        while (m_vElements.size() < capacity) {
+            m_vElements.resize(m_vElements.size() * 2);
+        }
+    }
+
+    size_t size() const { return m_nSize; }
+    bool empty() const { return m_nSize == 0; }
+
+    T& operator[](size_t i) { return m_vElements[(m_nHead + i) & (m_vElements.size() - 1)]; }
+    T& front() { return (*this)[0]; }
+    T& back() { return (*this)[m_nSize - 1]; }
+
+    void push_back(const T& value) {
+        if (m_nSize == m_vElements.size()) {
+            Grow();
+        }
+        m_vElements[(m_nHead + m_nSize) & (m_vElements.size() - 1)] = value;
+        m_nSize++;
+    }
+
+    void pop_front() {
+        m_nHead = (m_nHead + 1) & (m_vElements.size() - 1);
+        m_nSize--;
+    }
+
+    void pop_back() { m_nSize--; }
+
+    void clear() { m_nHead = m_nSize = 0; }
+
+private:
+    void Grow() {
+        std::vector<T> vElements(m_vElements.size() * 2);
+        for (size_t i = 0; i < m_nSize; i++) {
+            vElements[i] = (*this)[i];
+        }
+        m_vElements.swap(vElements);
+        m_nHead = 0;
+    }
+
+    std::vector<T> m_vElements;
+    size_t m_nHead = 0, m_nSize = 0;
 };
 
 inline void CheckInputFile(const char *szInFilePath) {